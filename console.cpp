@@ -20,12 +20,25 @@
  */
 
 
+#include "qdengine/qdengine.h"
 #include "qdengine/console.h"
+#include "qdengine/qdcore/qd_game_dispatcher.h"
+#include "qdengine/qdcore/qd_game_scene.h"
+#include "qdengine/qdcore/qd_interface_dispatcher.h"
+#include "qdengine/qdcore/qd_interface_screen.h"
+#include "qdengine/qdcore/util/profiler.h"
+#include "qdengine/qdcore/util/trace_recorder.h"
 
 namespace QDEngine {
 
 Console::Console() : GUI::Debugger() {
 	registerCmd("test",   WRAP_METHOD(Console, Cmd_test));
+	registerCmd("pathfinding",   WRAP_METHOD(Console, Cmd_pathfinding));
+	registerCmd("fastforward",   WRAP_METHOD(Console, Cmd_fastforward));
+	registerCmd("prof",   WRAP_METHOD(Console, Cmd_prof));
+	registerCmd("fps",   WRAP_METHOD(Console, Cmd_fps));
+	registerCmd("trace",   WRAP_METHOD(Console, Cmd_trace));
+	registerCmd("mem",   WRAP_METHOD(Console, Cmd_mem));
 }
 
 Console::~Console() {
@@ -36,4 +49,186 @@ bool Console::Cmd_test(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::Cmd_pathfinding(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Usage: %s [sync|async]\n", argv[0]);
+		return true;
+	}
+
+	if (argc == 2) {
+		if (!strcmp(argv[1], "sync")) {
+			g_engine->_asyncPathfinding = false;
+		} else if (!strcmp(argv[1], "async")) {
+			g_engine->_asyncPathfinding = true;
+		} else {
+			debugPrintf("Unknown mode '%s'\n", argv[1]);
+			return true;
+		}
+	}
+
+	debugPrintf("Pathfinding: %s\n", g_engine->_asyncPathfinding ? "async" : "sync");
+	return true;
+}
+
+bool Console::Cmd_fastforward(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Usage: %s [<quants>|on|off]\n", argv[0]);
+		return true;
+	}
+
+	if (argc == 2) {
+		if (!strcmp(argv[1], "on")) {
+			g_engine->_fastForwardQuants = -1;
+		} else if (!strcmp(argv[1], "off")) {
+			g_engine->_fastForwardQuants = 0;
+		} else if (atoi(argv[1]) > 0) {
+			g_engine->_fastForwardQuants = atoi(argv[1]);
+		} else {
+			debugPrintf("Unknown mode '%s'\n", argv[1]);
+			return true;
+		}
+	}
+
+	if (g_engine->_fastForwardQuants < 0)
+		debugPrintf("Fast-forward: on\n");
+	else if (g_engine->_fastForwardQuants > 0)
+		debugPrintf("Fast-forward: %d quants left\n", g_engine->_fastForwardQuants);
+	else
+		debugPrintf("Fast-forward: off\n");
+
+	debugPrintf("Last measured rate: %d quants/s\n", g_engine->_fastForwardRate);
+	return true;
+}
+
+bool Console::Cmd_prof(int argc, const char **argv) {
+#ifndef __QD_PROFILE_DISABLE__
+	if (argc != 2) {
+		debugPrintf("Usage: %s on|off|dump|reset\n", argv[0]);
+		debugPrintf("Profiler: %s\n", qdProfiler::is_enabled() ? "on" : "off");
+		return true;
+	}
+
+	if (!strcmp(argv[1], "on")) {
+		qdProfiler::instance().enable(true);
+	} else if (!strcmp(argv[1], "off")) {
+		qdProfiler::instance().enable(false);
+	} else if (!strcmp(argv[1], "dump")) {
+		debugPrintf("%s", qdProfiler::instance().report().c_str());
+		return true;
+	} else if (!strcmp(argv[1], "reset")) {
+		qdProfiler::instance().reset();
+	} else {
+		debugPrintf("Unknown mode '%s'\n", argv[1]);
+		return true;
+	}
+
+	debugPrintf("Profiler: %s\n", qdProfiler::is_enabled() ? "on" : "off");
+#else
+	debugPrintf("Profiler is not compiled in\n");
+#endif
+	return true;
+}
+
+bool Console::Cmd_fps(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	fpsCounter *fps = qdGameScene::fps_counter();
+
+	if (argc == 2) {
+		fps->reset();
+		debugPrintf("Frame statistics reset\n");
+		return true;
+	}
+
+	debugPrintf("FPS: %.1f (min %.1f, max %.1f)\n", fps->fps_value(), fps->fps_value_min(), fps->fps_value_max());
+	debugPrintf("Times in ms, p50/p90/p99/max:\n");
+	debugPrintf("  frame:  %s (%d samples)\n", fps->frame_times().to_string().c_str(), fps->frame_times().size());
+	debugPrintf("  logic:  %s (%d samples)\n", fps->logic_times().to_string().c_str(), fps->logic_times().size());
+	debugPrintf("  redraw: %s (%d samples)\n", fps->redraw_times().to_string().c_str(), fps->redraw_times().size());
+	return true;
+}
+
+bool Console::Cmd_trace(int argc, const char **argv) {
+#ifndef __QD_PROFILE_DISABLE__
+	qdTraceRecorder &recorder = qdTraceRecorder::instance();
+
+	if (argc >= 3 && argc <= 5 && !strcmp(argv[1], "start")) {
+		uint32 duration = argc > 3 ? atoi(argv[3]) : 0;
+		uint32 max_events = argc > 4 ? atoi(argv[4]) : 0;
+		recorder.start(argv[2], duration, max_events);
+	} else if (argc == 2 && !strcmp(argv[1], "stop")) {
+		if (recorder.is_recording()) {
+			Common::String file_name = recorder.file_name();
+			int count = recorder.event_count();
+			if (recorder.stop())
+				debugPrintf("%d events written to %s\n", count, file_name.c_str());
+			else
+				debugPrintf("Can't write %s\n", file_name.c_str());
+		}
+	} else if (argc != 1) {
+		debugPrintf("Usage: %s [start <file> [<duration ms> [<max events>]]|stop]\n", argv[0]);
+		return true;
+	}
+
+	if (recorder.is_recording())
+		debugPrintf("Trace: recording to %s, %d events\n", recorder.file_name().c_str(), recorder.event_count());
+	else
+		debugPrintf("Trace: off\n");
+#else
+	debugPrintf("Trace recorder is not compiled in\n");
+#endif
+	return true;
+}
+
+bool Console::Cmd_mem(int argc, const char **argv) {
+	if (argc == 3 && !strcmp(argv[1], "budget")) {
+		g_engine->_memoryBudget = MAX(0, atoi(argv[2]));
+	} else if (argc != 1) {
+		debugPrintf("Usage: %s [budget <KB>]\n", argv[0]);
+		return true;
+	}
+
+	qdGameDispatcher *dp = qdGameDispatcher::get_dispatcher();
+	if (!dp) {
+		debugPrintf("No game loaded\n");
+		return true;
+	}
+
+	// Общие ресурсы учитываются в каждой сцене и экране, где они используются,
+	// но только один раз в итоге.
+	qdResourceMemoryStats global;
+	dp->memory_stats(global);
+	debugPrintf("Global: %s\n", global.to_string().c_str());
+
+	for (auto &it : dp->scene_list()) {
+		qdResourceMemoryStats stats;
+		it->memory_stats(stats);
+		if (stats.total_size())
+			debugPrintf("Scene %s%s: %s\n", (const char *)transCyrillic(it->name()), it == dp->get_active_scene() ? " (active)" : "", stats.to_string().c_str());
+	}
+
+	if (qdInterfaceDispatcher *ip = qdInterfaceDispatcher::get_dispatcher()) {
+		for (auto &it : ip->screen_list()) {
+			qdResourceMemoryStats stats;
+			it->memory_stats(stats);
+			if (stats.total_size())
+				debugPrintf("Screen %s: %s\n", (const char *)transCyrillic(it->name()), stats.to_string().c_str());
+		}
+	}
+
+	qdResourceMemoryStats total;
+	dp->total_memory_stats(total);
+	debugPrintf("Total: %s\n", total.to_string().c_str());
+
+	if (g_engine->_memoryBudget)
+		debugPrintf("Budget: %u KB%s\n", g_engine->_memoryBudget, dp->check_memory_budget() ? "" : ", exceeded");
+	else
+		debugPrintf("Budget: off\n");
+
+	return true;
+}
+
 } // namespace Qdengine
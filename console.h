@@ -30,6 +30,12 @@ namespace QDEngine {
 class Console : public GUI::Debugger {
 private:
 	bool Cmd_test(int argc, const char **argv);
+	bool Cmd_pathfinding(int argc, const char **argv);
+	bool Cmd_fastforward(int argc, const char **argv);
+	bool Cmd_prof(int argc, const char **argv);
+	bool Cmd_fps(int argc, const char **argv);
+	bool Cmd_trace(int argc, const char **argv);
+	bool Cmd_mem(int argc, const char **argv);
 public:
 	Console();
 	~Console() override;
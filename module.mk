@@ -21,6 +21,7 @@ MODULE_OBJS = \
 	system/graphics/gr_tile_sprite.o \
 	system/graphics/rle_compress.o \
 	system/graphics/UI_TextParser.o \
+	system/input/input_recorder.o \
 	system/input/input_wndproc.o \
 	system/input/keyboard_input.o \
 	system/input/mouse_input.o \
@@ -28,8 +29,10 @@ MODULE_OBJS = \
 	qdcore/util/fps_counter.o \
 	qdcore/util/LZ77.o \
 	qdcore/util/plaympp_api.o \
+	qdcore/util/profiler.o \
 	qdcore/util/ResourceDispatcher.o \
 	qdcore/util/splash_screen.o \
+	qdcore/util/trace_recorder.o \
 	qdcore/util/WinVideo.o \
 	qdcore/qd_animation_frame.o \
 	qdcore/qd_animation_info.o \
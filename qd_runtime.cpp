@@ -21,8 +21,11 @@
 
 #include "common/archive.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/events.h"
 
+#include "audio/mixer.h"
+
 #include "qdengine/resource.h"
 #include "qdengine/qdcore/qd_game_dispatcher.h"
 #include "qdengine/qdcore/qd_game_scene.h"
@@ -31,10 +34,13 @@
 #include "qdengine/system/sound/snd_dispatcher.h"
 #include "qdengine/qdcore/qd_file_manager.h"
 #include "qdengine/qdcore/util/plaympp_api.h"
+#include "qdengine/qdcore/util/profiler.h"
 #include "qdengine/qdcore/util/splash_screen.h"
+#include "qdengine/qdcore/util/trace_recorder.h"
 #include "qdengine/qdcore/util/ResourceDispatcher.h"
 #include "qdengine/qdcore/util/WinVideo.h"
 #include "qdengine/system/graphics/gr_dispatcher.h"
+#include "qdengine/system/input/input_recorder.h"
 #include "qdengine/system/input/input_wndproc.h"
 #include "qdengine/system/input/mouse_input.h"
 #include "qdengine/system/input/keyboard_input.h"
@@ -59,6 +65,13 @@ qdGameDispatcher *qd_gameD = NULL;
 
 using namespace qdrt;
 
+// Longest sleep of the paced main loop, keeps input polling responsive
+static const uint32 kFramePacingSlice = 4;
+// Wall-clock time of one fast-forward batch of logic quants between event polls
+static const uint32 kFastForwardSlice = 50;
+// Default event limit of the timeline trace, keeps its buffer within tens of MB
+static const uint32 kTraceMaxEvents = 1000000;
+
 static void generateTagMap(int date, bool verbose = true) {
 	int n = 0;
 
@@ -169,6 +182,29 @@ int QDEngineEngine::engineMain() {
 
 	qdGameConfig::get_config().load();
 
+	// Запись или воспроизведение ввода, начальное значение генератора
+	// случайных чисел должно совпадать, поэтому задается до загрузки игры.
+	inputRecorder *recorder = inputRecorder::instance();
+	if (ConfMan.hasKey("replay_input")) {
+		if (recorder->start_replay(ConfMan.get("replay_input").c_str())) {
+			setSeed(recorder->random_seed());
+
+			if (recorder->logic_period() != qdGameConfig::get_config().logic_period())
+				warning("Input recording was made with logic period %d, current is %d", recorder->logic_period(), qdGameConfig::get_config().logic_period());
+		}
+	} else if (ConfMan.hasKey("record_input"))
+		recorder->start_recording(ConfMan.get("record_input").c_str(), getSeed(), qdGameConfig::get_config().logic_period());
+
+	// Запись временной шкалы, ограничена по времени (мс) и/или по количеству событий
+	if (ConfMan.hasKey("trace_file")) {
+		int trace_duration = ConfMan.hasKey("trace_duration") ? MAX(0, ConfMan.getInt("trace_duration")) : 0;
+		int trace_max_events = ConfMan.hasKey("trace_max_events") ? ConfMan.getInt("trace_max_events") : 0;
+		// Без ограничения на количество событий буфер может занять всю память
+		if (trace_max_events <= 0)
+			trace_max_events = kTraceMaxEvents;
+		qdTraceRecorder::instance().start(ConfMan.get("trace_file").c_str(), trace_duration, trace_max_events);
+	}
+
 	SplashScreen sp;
 	if (qdGameConfig::get_config().is_splash_enabled()) {
 		sp.create(IDB_SPLASH);
@@ -240,6 +276,24 @@ int QDEngineEngine::engineMain() {
 	bool exit_flag = false;
 	bool was_inactive = false;
 
+	// Ввод, который еще не обработан в кванте
+	bool has_input = false;
+	uint32 last_frame_time = 0;
+
+	// Ускоренная прокрутка логики, см. QDEngineEngine::_fastForwardQuants
+	bool fast_forward = false;
+	bool sfx_muted = false;
+	bool music_muted = false;
+	uint32 ff_start_time = 0;
+	uint32 ff_report_time = 0;
+	int ff_quants = 0;
+	int ff_total_quants = 0;
+
+	// Суммарное время воспроизведения записи ввода
+	uint32 replay_quants = 0;
+	uint32 replay_logic_time = 0;
+	uint32 replay_redraw_time = 0;
+
 	// Activate the window
 	grDispatcher::activate(true);
 
@@ -247,6 +301,8 @@ int QDEngineEngine::engineMain() {
 
 	while (!exit_flag && !qd_gameD->need_exit()) {
 		while (g_system->getEventManager()->pollEvent(event)) {
+			has_input = true;
+
 			switch (event.type) {
 			case Common::EVENT_QUIT:
 				if (!grDispatcher::instance()->is_in_reinit_mode())
@@ -280,8 +336,13 @@ int QDEngineEngine::engineMain() {
 				break;
 			}
 
-			input::keyboard_wndproc(event, keyboardDispatcher::instance());
-			input::mouse_wndproc(event, mouseDispatcher::instance());
+			// При воспроизведении записи живой ввод в игру не передается.
+			if (!recorder->is_replaying()) {
+				recorder->record_event(event, qd_gameD->quant_index());
+
+				input::keyboard_wndproc(event, keyboardDispatcher::instance());
+				input::mouse_wndproc(event, mouseDispatcher::instance());
+			}
 		}
 
 		if (grDispatcher::instance()->is_mouse_hidden())
@@ -289,6 +350,113 @@ int QDEngineEngine::engineMain() {
 		else
 			grDispatcher::instance()->set_default_mouse_cursor();
 
+		// В режиме ускоренной прокрутки логические кванты идут подряд с фиксированным
+		// шагом, без отрисовки, вывода на экран и звука.
+		if (_fastForwardQuants) {
+			if (!fast_forward) {
+				fast_forward = true;
+
+				Audio::Mixer *mixer = g_system->getMixer();
+				sfx_muted = mixer->isSoundTypeMuted(Audio::Mixer::kSFXSoundType);
+				music_muted = mixer->isSoundTypeMuted(Audio::Mixer::kMusicSoundType);
+				mixer->muteSoundType(Audio::Mixer::kSFXSoundType, true);
+				mixer->muteSoundType(Audio::Mixer::kMusicSoundType, true);
+
+				ff_start_time = ff_report_time = g_system->getMillis();
+				ff_quants = ff_total_quants = 0;
+
+				debug("Fast-forward started");
+			}
+
+			QD_TRACE_SCOPE("fast_forward");
+
+			uint32 batch_start = g_system->getMillis();
+			do {
+				qd_gameD->quant();
+				// Каждый квант считается отдельным кадром профилировщика.
+				QD_PROFILE_END_FRAME();
+
+				ff_quants++;
+				if (_fastForwardQuants > 0)
+					_fastForwardQuants--;
+			} while (_fastForwardQuants && !qd_gameD->need_exit() && g_system->getMillis() - batch_start < kFastForwardSlice);
+
+			uint32 now = g_system->getMillis();
+			if (now - ff_report_time >= 1000 || !_fastForwardQuants) {
+				if (now > ff_report_time)
+					_fastForwardRate = ff_quants * 1000 / (now - ff_report_time);
+
+				debug("Fast-forward: %d quants/s", _fastForwardRate);
+
+				ff_total_quants += ff_quants;
+				ff_quants = 0;
+				ff_report_time = now;
+			}
+
+			continue;
+		} else if (fast_forward) {
+			fast_forward = false;
+
+			g_system->getMixer()->muteSoundType(Audio::Mixer::kSFXSoundType, sfx_muted);
+			g_system->getMixer()->muteSoundType(Audio::Mixer::kMusicSoundType, music_muted);
+
+			// Время, прошедшее за прокрутку, логика не наверстывает
+			resD.skip_time();
+			qd_gameD->toggle_full_redraw();
+
+			debug("Fast-forward stopped: %d quants in %d ms", ff_total_quants, int(g_system->getMillis() - ff_start_time));
+		}
+
+		// Воспроизведение записанного ввода: по одному кванту с фиксированным шагом
+		// на итерацию, кадры рисуются там же, где и при записи. Время логики
+		// кванта и предшествующих ему отрисовок выводится в лог.
+		if (recorder->is_replaying()) {
+			QD_TRACE_SCOPE("replay_quant");
+
+			bool replay_screen_changed = false;
+			uint32 redraw_time = 0;
+
+			inputRecorder::recordType record_type;
+			Common::Event replay_event;
+			while (recorder->next_record(qd_gameD->quant_index(), record_type, replay_event)) {
+				if (record_type == inputRecorder::RECORD_REDRAW) {
+					uint32 redraw_start = g_system->getMillis();
+					if (qd_gameD->redraw())
+						replay_screen_changed = true;
+					redraw_time += g_system->getMillis() - redraw_start;
+				} else {
+					input::keyboard_wndproc(replay_event, keyboardDispatcher::instance());
+					input::mouse_wndproc(replay_event, mouseDispatcher::instance());
+				}
+			}
+
+			uint32 quant_start = g_system->getMillis();
+			qd_gameD->quant();
+			uint32 logic_time = g_system->getMillis() - quant_start;
+			QD_PROFILE_END_FRAME();
+
+			replay_quants++;
+			replay_logic_time += logic_time;
+			replay_redraw_time += redraw_time;
+
+			debug("Replay quant %u: logic %u ms, redraw %u ms", qd_gameD->quant_index(), logic_time, redraw_time);
+
+			if (replay_screen_changed)
+				g_system->updateScreen();
+
+			if (recorder->is_replay_finished()) {
+				debug("Replay finished: %u quants, logic %u ms, redraw %u ms", replay_quants, replay_logic_time, replay_redraw_time);
+
+				recorder->stop();
+				resD.skip_time();
+			}
+
+			continue;
+		}
+
+		// Если изображение не изменилось, на экран оно заново не выводится
+		bool screen_changed = true;
+
 		if (grDispatcher::is_active()) {
 			if (was_inactive) {
 				was_inactive = false;
@@ -296,8 +464,36 @@ int QDEngineEngine::engineMain() {
 				// на наше приложение (предположение)
 				g_system->delayMillis(500);
 			}
-			resD.quant();
-			qd_gameD->redraw();
+
+			// Если нет ни ввода, ни кванта логики, ни права на следующий кадр -
+			// ждем их короткими задержками, вместо того чтобы крутить цикл вхолостую.
+			if (_framePacing) {
+				uint32 now = g_system->getMillis();
+				uint32 delay = has_input ? 0 : resD.time_to_next_quant();
+
+				if (_frameRateCap > 0) {
+					uint32 frame_period = 1000 / _frameRateCap;
+					if (now - last_frame_time < frame_period)
+						delay = MAX(delay, frame_period - (now - last_frame_time));
+				}
+
+				if (delay) {
+					g_system->delayMillis(MIN<uint32>(delay, kFramePacingSlice));
+					continue;
+				}
+
+				last_frame_time = now;
+			}
+
+			has_input = false;
+
+			{
+				QD_TRACE_SCOPE("logic");
+				resD.quant();
+			}
+			screen_changed = qd_gameD->redraw();
+			recorder->record_redraw(qd_gameD->quant_index());
+			QD_PROFILE_END_FRAME();
 
 		} else {
 			was_inactive = true;
@@ -305,9 +501,15 @@ int QDEngineEngine::engineMain() {
 			resD.skip_time();
 		}
 
-		g_system->updateScreen();
+		if (screen_changed) {
+			QD_TRACE_SCOPE("update_screen");
+			g_system->updateScreen();
+		}
 	}
 
+	recorder->stop();
+	qdTraceRecorder::instance().stop();
+
 	delete qd_gameD;
 
 	grDispatcher::instance()->finit();
@@ -39,6 +39,7 @@
 
 #include "qdengine/qdcore/qd_animation.h"
 #include "qdengine/qdcore/qd_file_manager.h"
+#include "qdengine/qdcore/util/profiler.h"
 
 
 namespace QDEngine {
@@ -437,6 +438,8 @@ bool qdAnimation::load_resources() {
 	debugC(3, kDebugLoad, "qdAnimation::load_resources(): '%s' name: %s", transCyrillic(qda_file()), transCyrillic(name()));
 	if (check_flag(QD_ANIMATION_FLAG_REFERENCE)) return false;
 
+	QD_PROFILE_SCOPE(PROFILE_RESOURCE_LOAD);
+
 	if (!qda_file()) {
 		qdAnimationFrameList::iterator iaf;
 		for (iaf = _frames.begin(); iaf != _frames.end(); ++iaf) {
@@ -1073,7 +1076,6 @@ const qdAnimationFrame *qdAnimation::get_scaled_frame(int number, int scale_inde
 	return NULL;
 }
 
-#ifdef __QD_DEBUG_ENABLE__
 uint32 qdAnimation::resource_data_size() const {
 	uint32 size = 0;
 
@@ -1083,7 +1085,10 @@ uint32 qdAnimation::resource_data_size() const {
 	for (qdAnimationFrameList::const_iterator it = _scaled_frames.begin(); it != _scaled_frames.end(); ++it)
 		size += (*it)->resource_data_size();
 
+	if (_tileAnimation)
+		size += _tileAnimation->data_size();
+
 	return size;
 }
-#endif
+
 } // namespace QDEngine
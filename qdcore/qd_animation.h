@@ -247,9 +247,8 @@ public:
 		} else
 			return qda_file();
 	}
-#ifdef __QD_DEBUG_ENABLE__
+	//! Объем данных кадров, в том числе масштабированных, и тайловой анимации.
 	uint32 resource_data_size() const;
-#endif
 
 	//! Загрузка данных из сэйва.
 	bool load_data(Common::SeekableReadStream &fh, int save_version);
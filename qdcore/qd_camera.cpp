@@ -95,7 +95,8 @@ const float qdCamera::_FAR_PLANE = 10000;
 //qdCameraMode qdCamera::_default_mode;
 
 qdCamera::qdCamera() : _m_fR(300.0f), _xAngle(45), _yAngle(0), _zAngle(0),
-	_GSX(0), _GSY(0), _grid(NULL),
+	_GSX(0), _GSY(0), _grid(NULL), _grid_row_words(0), _grid_version(0),
+	_passable_version(1), _footprint_epoch(0), _footprints_synced(false), _nearest_passable_version(0),
 	_cellSX(32), _cellSY(32), _focus(1000.0f),
 	_gridCenter(0, 0, 0),
 	_redraw_mode(QDCAM_GRID_ZBUFFER),
@@ -132,6 +133,10 @@ void qdCamera::set_grid_size(int xs, int ys) {
 
 	_GSX = xs;
 	_GSY = ys;
+
+	init_grid_footprints();
+	build_grid_planes();
+	update_grid_version();
 }
 
 void qdCamera::clear_grid() {
@@ -142,7 +147,278 @@ void qdCamera::clear_grid() {
 			_grid[cnt++].clear();
 		}
 	}
+
+	init_grid_footprints();
+	build_grid_planes();
+	update_grid_version();
+}
+
+void qdCamera::update_grid_version() {
+	_grid_version = cell_version(_GSX, _GSY);
+
+	const sGridCell *p = _grid;
+	for (int i = 0; i < _GSX * _GSY; i++, p++)
+		_grid_version ^= cell_version(i, p->attributes());
+
+	_passable_version++;
+}
+
+void qdCamera::build_grid_planes() {
+	_grid_row_words = (_GSX + 63) / 64;
+
+	for (int i = 0; i < GRID_PLANES_COUNT; i++) {
+		_grid_planes[i].clear();
+		_grid_planes[i].resize(_grid_row_words * _GSY, 0);
+	}
+
+	const sGridCell *p = _grid;
+	for (int y = 0; y < _GSY; y++) {
+		for (int x = 0; x < _GSX; x++, p++) {
+			uint32 attr = p->attributes();
+			uint64 bit = uint64(1) << (x & 63);
+			int word = y * _grid_row_words + (x >> 6);
+
+			for (int i = 0; attr; i++, attr >>= 1) {
+				if (attr & 1)
+					_grid_planes[i][word] |= bit;
+			}
+		}
+	}
+}
+
+void qdCamera::change_grid_word_attributes(int y, int word, uint64 bits, int attr, bool set) {
+	sGridCell *cells = _grid + y * _GSX + (word << 6);
+	for (int x = 0; bits; x++, bits >>= 1) {
+		if (bits & 1) {
+			if (set)
+				change_cell_attributes(cells + x, cells[x].attributes() | attr);
+			else
+				change_cell_attributes(cells + x, cells[x].attributes() & ~attr);
+		}
+	}
+}
+
+void qdCamera::change_grid_rect_attributes(int x0, int y0, int x1, int y1, int attr, bool set) {
+	if (x0 >= x1 || y0 >= y1) return;
+
+	int w0 = x0 >> 6;
+	int w1 = (x1 - 1) >> 6;
+
+	for (int y = y0; y < y1; y++) {
+		int offset = y * _grid_row_words;
+		for (int w = w0; w <= w1; w++) {
+			// Трогаем только клетки, у которых атрибуты действительно меняются.
+			uint64 bits = grid_row_mask(x0, x1, w);
+			if (set)
+				bits &= ~grid_plane_all(attr, offset + w);
+			else
+				bits &= grid_plane_any(attr, offset + w);
+
+			if (bits)
+				change_grid_word_attributes(y, w, bits, attr, set);
+		}
+	}
+}
+
+//! Биты маски строки row, начиная с бита start (может быть отрицательным).
+static uint64 grid_mask_bits(const uint64 *row, int row_words, int start) {
+	if (start <= -64 || start >= row_words * 64) return 0;
+	if (start < 0) return row[0] << -start;
+
+	int i = start >> 6;
+	int shift = start & 63;
+
+	uint64 bits = row[i] >> shift;
+	if (shift && i + 1 < row_words)
+		bits |= row[i + 1] << (64 - shift);
+
+	return bits;
+}
+
+void qdCamera::change_grid_mask_attributes(const Vect2s &pos, const Vect2s &size, const uint64 *mask, int row_words, int attr, bool set) {
+	int x0 = MAX<int>(pos.x, 0);
+	int x1 = MIN<int>(pos.x + row_words * 64, _GSX);
+	if (x0 >= x1) return;
+
+	int w0 = x0 >> 6;
+	int w1 = (x1 - 1) >> 6;
+
+	for (int y = 0; y < size.y; y++, mask += row_words) {
+		int cy = pos.y + y;
+		if (cy < 0 || cy >= _GSY) continue;
+
+		int offset = cy * _grid_row_words;
+		for (int w = w0; w <= w1; w++) {
+			uint64 bits = grid_mask_bits(mask, row_words, (w << 6) - pos.x) & grid_row_mask(x0, x1, w);
+			if (set)
+				bits &= ~grid_plane_all(attr, offset + w);
+			else
+				bits &= grid_plane_any(attr, offset + w);
+
+			if (bits)
+				change_grid_word_attributes(cy, w, bits, attr, set);
+		}
+	}
+}
+
+//! Количество единичных бит.
+static inline int grid_popcount(uint64 v) {
+#if defined(__GNUC__)
+	return __builtin_popcountll(v);
+#else
+	v = v - ((v >> 1) & 0x5555555555555555ULL);
+	v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+	v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+void qdCamera::init_grid_footprints() {
+	_occupied_count.clear();
+	_occupied_count.resize(_GSX * _GSY, 0);
+	_personage_count.clear();
+	_personage_count.resize(_GSX * _GSY, 0);
+
+	_footprint_epoch++;
+	_footprints_synced = false;
+}
+
+void qdCamera::reset_grid_footprints() {
+	drop_grid_attributes(sGridCell::CELL_OCCUPIED | sGridCell::CELL_PERSONAGE_OCCUPIED);
+	init_grid_footprints();
+}
+
+void qdCamera::sync_grid_footprints() {
+	if (_footprints_synced)
+		return;
+
+	_footprints_synced = true;
+
+	for (int idx = 0; idx < _GSX * _GSY; idx++) {
+		uint32 attr = _grid[idx].attributes() & ~(sGridCell::CELL_OCCUPIED | sGridCell::CELL_PERSONAGE_OCCUPIED);
+		if (_occupied_count[idx])
+			attr |= sGridCell::CELL_OCCUPIED;
+		if (_personage_count[idx])
+			attr |= sGridCell::CELL_PERSONAGE_OCCUPIED;
+
+		if (attr != _grid[idx].attributes())
+			change_cell_attributes(_grid + idx, attr);
+	}
+}
+
+void qdCamera::grid_rect(const Vect2s &center, const Vect2s &size, int &x0, int &y0, int &x1, int &y1) const {
+	x0 = center.x - size.x / 2;
+	y0 = center.y - size.y / 2;
+
+	x1 = x0 + size.x;
+	y1 = y0 + size.y;
+
+	if (x0 < 0) x0 = 0;
+	if (x1 > _GSX - 1) x1 = _GSX - 1;
+	if (y0 < 0) y0 = 0;
+	if (y1 > _GSY - 1) y1 = _GSY - 1;
+}
+
+bool qdCamera::move_grid_footprint(const Vect2s &old_center, const Vect2s &old_size, const Vect2s &new_center, const Vect2s &new_size, int attr) {
+	Std::vector<uint16> *counts;
+	if (attr == sGridCell::CELL_OCCUPIED)
+		counts = &_occupied_count;
+	else if (attr == sGridCell::CELL_PERSONAGE_OCCUPIED)
+		counts = &_personage_count;
+	else
+		return false;
+
+	int ox0, oy0, ox1, oy1;
+	grid_rect(old_center, old_size, ox0, oy0, ox1, oy1);
+	int nx0, ny0, nx1, ny1;
+	grid_rect(new_center, new_size, nx0, ny0, nx1, ny1);
+
+	// Клетки, которые покидает отпечаток.
+	for (int y = oy0; y < oy1; y++) {
+		bool in_new_row = (y >= ny0 && y < ny1);
+		for (int x = ox0; x < ox1; x++) {
+			if (in_new_row && x >= nx0 && x < nx1)
+				continue;
+
+			int idx = x + y * _GSX;
+			uint16 &cnt = (*counts)[idx];
+			if (cnt && !--cnt)
+				change_cell_attributes(_grid + idx, _grid[idx].attributes() & ~attr);
+		}
+	}
+
+	// Клетки, которые отпечаток занимает.
+	for (int y = ny0; y < ny1; y++) {
+		bool in_old_row = (y >= oy0 && y < oy1);
+		for (int x = nx0; x < nx1; x++) {
+			if (in_old_row && x >= ox0 && x < ox1)
+				continue;
+
+			int idx = x + y * _GSX;
+			if (!(*counts)[idx]++)
+				change_cell_attributes(_grid + idx, _grid[idx].attributes() | attr);
+		}
+	}
+
+	return true;
 }
+
+void qdCamera::build_nearest_passable_cells() const {
+	debugC(3, kDebugMovement, "qdCamera::build_nearest_passable_cells()");
+
+	int size = _GSX * _GSY;
+	_nearest_passable.resize(size);
+
+	Std::vector<int> queue;
+	queue.reserve(size);
+
+	for (int i = 0; i < size; i++) {
+		if (!_grid[i].check_attribute(sGridCell::CELL_IMPASSABLE)) {
+			_nearest_passable[i] = i;
+			queue.push_back(i);
+		} else
+			_nearest_passable[i] = -1;
+	}
+
+	static const int dx[8] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+	static const int dy[8] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+
+	for (uint head = 0; head < queue.size(); head++) {
+		int idx = queue[head];
+		int x = idx % _GSX;
+		int y = idx / _GSX;
+
+		for (int i = 0; i < 8; i++) {
+			int nx = x + dx[i];
+			int ny = y + dy[i];
+			if (nx < 0 || nx >= _GSX || ny < 0 || ny >= _GSY)
+				continue;
+
+			int nidx = nx + ny * _GSX;
+			if (_nearest_passable[nidx] == -1) {
+				_nearest_passable[nidx] = _nearest_passable[idx];
+				queue.push_back(nidx);
+			}
+		}
+	}
+
+	_nearest_passable_version = _passable_version;
+}
+
+Vect2s qdCamera::get_nearest_passable_cell(const Vect2s &cell_pos) const {
+	if (cell_pos.x < 0 || cell_pos.x >= _GSX || cell_pos.y < 0 || cell_pos.y >= _GSY)
+		return Vect2s(-1, -1);
+
+	if (_nearest_passable_version != _passable_version)
+		build_nearest_passable_cells();
+
+	int idx = _nearest_passable[cell_pos.x + cell_pos.y * _GSX];
+	if (idx == -1)
+		return Vect2s(-1, -1);
+
+	return Vect2s(idx % _GSX, idx / _GSX);
+}
+
 float qdCamera::get_scale(const Vect3f &glCoord) const {
 	if ((_focus < 5000.0f) || (fabs(_scale_pow - 1) > 0.001)) {
 		Vect3f cameraCoord = global2camera_coord(glCoord);
@@ -365,7 +641,8 @@ void qdCamera::reset_all_select() {
 	int cnt = 0;
 	for (int i = 0; i < _GSY; i++) {
 		for (int j = 0; j < _GSX; j++) {
-			_grid[cnt++].deselect();
+			sGridCell *p = &_grid[cnt++];
+			change_cell_attributes(p, p->attributes() & ~sGridCell::CELL_SELECTED);
 		}
 	}
 }
@@ -382,7 +659,8 @@ bool qdCamera::select_cell(int x, int y) {
 	if (x < 0 || x >= XSP || y < 0 || y >= YSP) return false;
 	x = x / _cellSX;
 	y = y / _cellSY;
-	_grid[y * _GSX + x].select();
+	sGridCell *p = &_grid[y * _GSX + x];
+	change_cell_attributes(p, p->attributes() | sGridCell::CELL_SELECTED);
 	return true;
 }
 
@@ -398,7 +676,8 @@ bool qdCamera::deselect_cell(int x, int y) {
 	if (x < 0 || x >= XSP || y < 0 || y >= YSP) return false;
 	x = x / _cellSX;
 	y = y / _cellSY;
-	_grid[y * _GSX + x].deselect();
+	sGridCell *p = &_grid[y * _GSX + x];
+	change_cell_attributes(p, p->attributes() & ~sGridCell::CELL_SELECTED);
 	return true;
 }
 
@@ -836,6 +1115,10 @@ void qdCamera::scale_grid(int sx, int sy, int csx, int csy) {
 
 	_cellSX = csx;
 	_cellSY = csy;
+
+	init_grid_footprints();
+	build_grid_planes();
+	update_grid_version();
 }
 
 void qdCamera::resize_grid(int sx, int sy) {
@@ -861,6 +1144,10 @@ void qdCamera::resize_grid(int sx, int sy) {
 
 	_GSX = sx;
 	_GSY = sy;
+
+	init_grid_footprints();
+	build_grid_planes();
+	update_grid_version();
 }
 
 sGridCell *qdCamera::backup(sGridCell *ptrBuff) {
@@ -881,12 +1168,16 @@ bool qdCamera::restore(sGridCell *grid, int sx, int sy, int csx, int csy) {
 	_cellSX = csx;
 	_cellSY = csy;
 
+	init_grid_footprints();
+	build_grid_planes();
+	update_grid_version();
+
 	return true;
 }
 
 bool qdCamera::set_grid_cell(const Vect2s &cell_pos, const sGridCell &cell) {
 	if (cell_pos.x >= 0 && cell_pos.x < _GSX && cell_pos.y >= 0 && cell_pos.y < _GSY) {
-		_grid[cell_pos.x + cell_pos.y * _GSX] = cell;
+		change_cell_attributes(&_grid[cell_pos.x + cell_pos.y * _GSX], cell.attributes());
 		return true;
 	}
 
@@ -895,7 +1186,27 @@ bool qdCamera::set_grid_cell(const Vect2s &cell_pos, const sGridCell &cell) {
 
 bool qdCamera::set_grid_cell_attributes(const Vect2s &cell_pos, int attr) {
 	if (cell_pos.x >= 0 && cell_pos.x < _GSX && cell_pos.y >= 0 && cell_pos.y < _GSY) {
-		_grid[cell_pos.x + cell_pos.y * _GSX].set_attributes(attr);
+		change_cell_attributes(&_grid[cell_pos.x + cell_pos.y * _GSX], attr);
+		return true;
+	}
+
+	return false;
+}
+
+bool qdCamera::add_grid_cell_attributes(const Vect2s &cell_pos, int attr) {
+	if (cell_pos.x >= 0 && cell_pos.x < _GSX && cell_pos.y >= 0 && cell_pos.y < _GSY) {
+		sGridCell *p = &_grid[cell_pos.x + cell_pos.y * _GSX];
+		change_cell_attributes(p, p->attributes() | attr);
+		return true;
+	}
+
+	return false;
+}
+
+bool qdCamera::drop_grid_cell_attributes(const Vect2s &cell_pos, int attr) {
+	if (cell_pos.x >= 0 && cell_pos.x < _GSX && cell_pos.y >= 0 && cell_pos.y < _GSY) {
+		sGridCell *p = &_grid[cell_pos.x + cell_pos.y * _GSX];
+		change_cell_attributes(p, p->attributes() & ~attr);
 		return true;
 	}
 
@@ -906,7 +1217,7 @@ bool qdCamera::restore_grid_cell(const Vect2s cell_pos) {
 	if (cell_pos.x >= 0 && cell_pos.x < _GSX && cell_pos.y >= 0 && cell_pos.y < _GSY) {
 		sGridCell cl;
 		cl.make_impassable();
-		_grid[cell_pos.x + cell_pos.y * _GSX] = cl;
+		change_cell_attributes(&_grid[cell_pos.x + cell_pos.y * _GSX], cl.attributes());
 		return true;
 	}
 
@@ -1180,16 +1491,8 @@ bool qdCamera::set_grid_attributes(const Vect2s &center_pos, const Vect2s &size,
 	if (y0 < 0) y0 = 0;
 	if (y1 > _GSY - 1) y1 = _GSY - 1;
 
-	sGridCell *cells = _grid + x0 + y0 * _GSX;
-
 	debugC(4, kDebugMovement, "qdCamera::set_grid_attributes() attr: %d at [%d, %d]", attr, x0, y0);
-	for (int y = y0; y < y1; y++) {
-		sGridCell *p = cells;
-		for (int x = x0; x < x1; x++, p++)
-			p->set_attribute(attr);
-
-		cells += _GSX;
-	}
+	change_grid_rect_attributes(x0, y0, x1, y1, attr, true);
 
 	return true;
 }
@@ -1206,32 +1509,28 @@ bool qdCamera::drop_grid_attributes(const Vect2s &center_pos, const Vect2s &size
 	if (y0 < 0) y0 = 0;
 	if (y1 > _GSY - 1) y1 = _GSY - 1;
 
-	sGridCell *cells = _grid + x0 + y0 * _GSX;
+	change_grid_rect_attributes(x0, y0, x1, y1, attr, false);
 
-	for (int y = y0; y < y1; y++) {
-		sGridCell *p = cells;
-		for (int x = x0; x < x1; x++, p++)
-			p->drop_attribute(attr);
+	return true;
+}
 
-		cells += _GSX;
-	}
+bool qdCamera::set_grid_mask_attributes(const Vect2s &pos, const Vect2s &size, const uint64 *mask, int row_words, int attr) {
+	change_grid_mask_attributes(pos, size, mask, row_words, attr, true);
+	return true;
+}
 
+bool qdCamera::drop_grid_mask_attributes(const Vect2s &pos, const Vect2s &size, const uint64 *mask, int row_words, int attr) {
+	change_grid_mask_attributes(pos, size, mask, row_words, attr, false);
 	return true;
 }
 
 bool qdCamera::set_grid_attributes(int attr) {
-	sGridCell *p = _grid;
-	for (int i = 0; i < _GSX * _GSY; i++, p++)
-		p->set_attribute(attr);
-
+	change_grid_rect_attributes(0, 0, _GSX, _GSY, attr, true);
 	return true;
 }
 
 bool qdCamera::drop_grid_attributes(int attr) {
-	sGridCell *p = _grid;
-	for (int i = 0; i < _GSX * _GSY; i++, p++)
-		p->drop_attribute(attr);
-
+	change_grid_rect_attributes(0, 0, _GSX, _GSY, attr, false);
 	return true;
 }
 
@@ -1247,16 +1546,17 @@ bool qdCamera::check_grid_attributes(const Vect2s &center_pos, const Vect2s &siz
 	if (y0 < 0) y0 = 0;
 	if (y1 > _GSY - 1) y1 = _GSY - 1;
 
-	const sGridCell *cells = _grid + x0 + y0 * _GSX;
+	if (x0 >= x1 || y0 >= y1) return false;
+
+	int w0 = x0 >> 6;
+	int w1 = (x1 - 1) >> 6;
 
 	for (int y = y0; y < y1; y++) {
-		const sGridCell *p = cells;
-		for (int x = x0; x < x1; x++, p++) {
-			if (p->check_attribute(attr))
+		int offset = y * _grid_row_words;
+		for (int w = w0; w <= w1; w++) {
+			if (grid_plane_any(attr, offset + w) & grid_row_mask(x0, x1, w))
 				return true;
 		}
-
-		cells += _GSX;
 	}
 
 	return false;
@@ -1274,17 +1574,26 @@ int qdCamera::cells_num_with_exact_attributes(const Vect2s &center_pos, const Ve
 	if (y0 < 0) y0 = 0;
 	if (y1 > _GSY - 1) y1 = _GSY - 1;
 
-	const sGridCell *cells = _grid + x0 + y0 * _GSX;
+	// Атрибуты клетки помещаются в байт.
+	if (attr & ~0xFF) return 0;
+	if (x0 >= x1 || y0 >= y1) return 0;
+
+	int w0 = x0 >> 6;
+	int w1 = (x1 - 1) >> 6;
 
 	int ret = 0;
 	for (int y = y0; y < y1; y++) {
-		const sGridCell *p = cells;
-		for (int x = x0; x < x1; x++, p++) {
-			if (p->attributes() == attr)
-				ret++;
+		int offset = y * _grid_row_words;
+		for (int w = w0; w <= w1; w++) {
+			uint64 bits = grid_row_mask(x0, x1, w);
+			for (int i = 0; bits && i < GRID_PLANES_COUNT; i++) {
+				if (attr & (1 << i))
+					bits &= _grid_planes[i][offset + w];
+				else
+					bits &= ~_grid_planes[i][offset + w];
+			}
+			ret += grid_popcount(bits);
 		}
-
-		cells += _GSX;
 	}
 
 	return ret;
@@ -1302,24 +1611,28 @@ bool qdCamera::is_walkable(const Vect2s &center_pos, const Vect2s &size, bool ig
 	if (y0 < 0) y0 = 0;
 	if (y1 > _GSY - 1) y1 = _GSY - 1;
 
-	const sGridCell *cells = _grid + x0 + y0 * _GSX;
-	debugC(3, kDebugMovement, "qdCamera::is_walkable(): attr: %d [%d, %d] size: [%d, %d], ignore_personages: %d", cells->attributes(), x0, y0, size.x, size.y, ignore_personages);
+	debugC(3, kDebugMovement, "qdCamera::is_walkable(): [%d, %d] size: [%d, %d], ignore_personages: %d", x0, y0, size.x, size.y, ignore_personages);
 
 	int attr = sGridCell::CELL_IMPASSABLE | sGridCell::CELL_OCCUPIED;
 	if (!ignore_personages) {
 		attr |= sGridCell::CELL_PERSONAGE_OCCUPIED;
 	 }
 
-	for (int y = y0; y < y1; y++) {
-		const sGridCell *p = cells;
+	if (x0 >= x1 || y0 >= y1) return true;
 
-		for (int x = x0; x < x1; x++, p++) {
-			debugC(3, kDebugMovement, "qdCamera::is_walkable(): attr %d at [%d, %d]", p->attributes(), x, y);
-			if (p->check_attribute(attr) && !p->check_attribute(sGridCell::CELL_SELECTED)) {
+	int w0 = x0 >> 6;
+	int w1 = (x1 - 1) >> 6;
+
+	for (int y = y0; y < y1; y++) {
+		int offset = y * _grid_row_words;
+		for (int w = w0; w <= w1; w++) {
+			// Выделенные клетки считаются проходимыми
+			uint64 blocked = grid_plane_any(attr, offset + w) & ~grid_plane_any(sGridCell::CELL_SELECTED, offset + w);
+			if (blocked & grid_row_mask(x0, x1, w)) {
+				debugC(3, kDebugMovement, "qdCamera::is_walkable(): blocked at row %d", y);
 				return false;
 			}
 		}
-		cells += _GSX;
 	}
 
 	return true;
@@ -22,6 +22,9 @@
 #ifndef QDENGINE_QDCORE_QD_CAMERA_H
 #define QDENGINE_QDCORE_QD_CAMERA_H
 
+#include "common/util.h"
+#include "common/std/vector.h"
+
 #include "qdengine/qdcore/qd_d3dutils.h"
 #include "qdengine/qdcore/qd_camera_mode.h"
 
@@ -128,11 +131,23 @@ public:
 	// по параметрам клетки cell
 	bool set_grid_cell(const Vect2s &cell_pos, const sGridCell &cell);
 	bool set_grid_cell_attributes(const Vect2s &cell_pos, int attr);
+	//! Устанавливает атрибуты attr для клетки с координатами cell_pos, не трогая остальные.
+	bool add_grid_cell_attributes(const Vect2s &cell_pos, int attr);
+	//! Очищает атрибуты attr для клетки с координатами cell_pos.
+	bool drop_grid_cell_attributes(const Vect2s &cell_pos, int attr);
 
 	//! Устанавливает атрибуты для клеток из прямоугольника на сетке с ценром center_pos и размерами size.
 	bool set_grid_attributes(const Vect2s &center_pos, const Vect2s &size, int attr);
 	//! Очищает атрибуты для клеток из прямоугольника на сетке с ценром center_pos и размерами size.
 	bool drop_grid_attributes(const Vect2s &center_pos, const Vect2s &size, int attr);
+	//! Устанавливает атрибуты для клеток, отмеченных в битовой маске.
+	/**
+	pos - клетка, соответствующая первому биту маски, size - размеры маски в клетках,
+	row_words - количество 64-битных слов на строку маски (см. qdContour::rasterize()).
+	*/
+	bool set_grid_mask_attributes(const Vect2s &pos, const Vect2s &size, const uint64 *mask, int row_words, int attr);
+	//! Очищает атрибуты для клеток, отмеченных в битовой маске.
+	bool drop_grid_mask_attributes(const Vect2s &pos, const Vect2s &size, const uint64 *mask, int row_words, int attr);
 	//! Возвращает true, если в прямоугольнике на сетке ЕСТЬ ХОТЯ БЫ ОДНА ячейка с атрибутами attr.
 	bool check_grid_attributes(const Vect2s &center_pos, const Vect2s &size, int attr) const;
 	//! Возвращает количество ячеек в заданной области, имеющих именно аттрибуты attr
@@ -147,11 +162,37 @@ public:
 
 	bool is_walkable(const Vect2s &center_pos, const Vect2s &size, bool ignore_personages = false) const;
 
+	//! Перемещает отпечаток объекта на сетке.
+	/**
+	Отпечаток - прямоугольник с центром center и размерами size, как в set_grid_attributes().
+	attr - CELL_OCCUPIED или CELL_PERSONAGE_OCCUPIED. Для каждой клетки хранится количество
+	покрывающих ее отпечатков, атрибут стоит, пока оно не нулевое. Изменяются только клетки,
+	которые входят ровно в один из прямоугольников. Нулевой размер означает отсутствие отпечатка.
+	*/
+	bool move_grid_footprint(const Vect2s &old_center, const Vect2s &old_size, const Vect2s &new_center, const Vect2s &new_size, int attr);
+	//! Убирает с сетки все отпечатки объектов.
+	void reset_grid_footprints();
+	//! Приводит атрибуты CELL_OCCUPIED и CELL_PERSONAGE_OCCUPIED в соответствие со счетчиками отпечатков.
+	/**
+	Нужно после загрузки сетки из сэйва: там атрибуты могут стоять в клетках, где отпечатков нет.
+	Сетка просматривается только первый раз после обнуления счетчиков, дальше
+	атрибуты поддерживаются move_grid_footprint().
+	*/
+	void sync_grid_footprints();
+	//! Номер набора отпечатков, меняется при reset_grid_footprints() и пересоздании сетки.
+	/**
+	Отпечатки, поставленные с другим номером, уже сняты с сетки.
+	*/
+	uint32 footprint_epoch() const {
+		return _footprint_epoch;
+	}
+
 	//! Устанавливает атрибуты attr для всех клеток сетки.
 	bool set_grid_attributes(int attr);
 	//! Очищает атрибуты attr для всех клеток сетки.
 	bool drop_grid_attributes(int attr);
 
+	//! Изменения атрибутов через возвращаемый указатель не отслеживаются grid_version() и битовыми плоскостями сетки.
 	sGridCell *get_cell(const Vect2s &cell_pos);
 	const sGridCell *get_cell(const Vect2s &cell_pos) const;
 
@@ -184,6 +225,25 @@ public:
 		return _grid;
 	}
 
+	//! Версия состояния сетки.
+	/**
+	Меняется при любом изменении атрибутов клеток, влияющих на проходимость
+	(см. GRID_VERSION_ATTRIBUTES), и при изменении размеров сетки.
+	Значение вычисляется по содержимому сетки, поэтому временная установка
+	и последующее снятие атрибутов возвращают прежнюю версию.
+	*/
+	uint32 grid_version() const {
+		return _grid_version;
+	}
+
+	//! Возвращает ближайшую к cell_pos клетку без атрибута CELL_IMPASSABLE.
+	/**
+	Берется из таблицы ближайших проходимых клеток, которая пересчитывается
+	только при изменении непроходимости клеток сетки.
+	Если cell_pos за пределами сетки или проходимых клеток нет, возвращает (-1, -1).
+	*/
+	Vect2s get_nearest_passable_cell(const Vect2s &cell_pos) const;
+
 	int get_cell_sx() const {
 		return _cellSX;
 	}
@@ -428,6 +488,38 @@ private:
 	int _GSX, _GSY;
 	sGridCell *_grid;
 
+	//! Количество битовых плоскостей - по одной на каждый бит атрибутов клетки.
+	enum {
+		GRID_PLANES_COUNT = 8
+	};
+
+	//! Битовые плоскости атрибутов сетки.
+	/**
+	Плоскость i хранит бит (1 << i) атрибутов всех клеток, по _grid_row_words
+	64-битных слов на строку сетки, бит x % 64 слова x / 64 - клетка x.
+	Поддерживаются в соответствии с _grid в change_cell_attributes(),
+	по ним сделаны проверки прямоугольников сетки.
+	*/
+	Std::vector<uint64> _grid_planes[GRID_PLANES_COUNT];
+	int _grid_row_words;
+
+	//! Версия состояния сетки, см. grid_version().
+	uint32 _grid_version;
+
+	//! Счетчик изменений атрибута CELL_IMPASSABLE.
+	uint32 _passable_version;
+	//! Количество отпечатков объектов (CELL_OCCUPIED) и персонажей (CELL_PERSONAGE_OCCUPIED) в каждой клетке.
+	Std::vector<uint16> _occupied_count;
+	Std::vector<uint16> _personage_count;
+	uint32 _footprint_epoch;
+	//! true, если атрибуты занятости клеток после обнуления счетчиков уже приведены к ним.
+	bool _footprints_synced;
+
+	//! Значение _passable_version, для которого построена _nearest_passable.
+	mutable uint32 _nearest_passable_version;
+	//! Для каждой клетки - индекс ближайшей к ней клетки без CELL_IMPASSABLE, -1 если таких нет.
+	mutable Std::vector<int> _nearest_passable;
+
 	bool _cycle_x;
 	bool _cycle_y;
 
@@ -497,6 +589,101 @@ private:
 	}
 
 	void clip_center_coords(int &x, int &y) const;
+
+	//! Атрибуты клеток, от которых зависит проходимость и, соответственно, grid_version().
+	enum {
+		GRID_VERSION_ATTRIBUTES = sGridCell::CELL_SELECTED | sGridCell::CELL_IMPASSABLE | sGridCell::CELL_OCCUPIED | sGridCell::CELL_PERSONAGE_OCCUPIED
+	};
+
+	//! Вклад клетки с индексом idx и атрибутами attr в версию сетки.
+	static uint32 cell_version(int idx, uint32 attr) {
+		uint32 h = (uint32(idx) << 4) | (attr & GRID_VERSION_ATTRIBUTES);
+		h ^= h >> 16;
+		h *= 0x85EBCA6B;
+		h ^= h >> 13;
+		h *= 0xC2B2AE35;
+		h ^= h >> 16;
+		return h;
+	}
+
+	//! Установка атрибутов клетки сетки с обновлением версии и битовых плоскостей.
+	void change_cell_attributes(sGridCell *cell, uint32 attr) {
+		uint32 old_attr = cell->attributes();
+		cell->set_attributes(attr);
+		// set_attributes() обрезает атрибуты до байта
+		attr = cell->attributes();
+
+		uint32 diff = old_attr ^ attr;
+		if (!diff)
+			return;
+
+		int idx = cell - _grid;
+		if (diff & GRID_VERSION_ATTRIBUTES) {
+			_grid_version ^= cell_version(idx, old_attr) ^ cell_version(idx, attr);
+
+			if (diff & sGridCell::CELL_IMPASSABLE)
+				_passable_version++;
+		}
+
+		int y = idx / _GSX;
+		int x = idx - y * _GSX;
+		int word = y * _grid_row_words + (x >> 6);
+		uint64 bit = uint64(1) << (x & 63);
+		for (int i = 0; diff; i++, diff >>= 1) {
+			if (diff & 1)
+				_grid_planes[i][word] ^= bit;
+		}
+	}
+
+	//! Построение битовых плоскостей по _grid.
+	void build_grid_planes();
+
+	//! Биты слова word строки сетки, соответствующие клеткам [x0, x1).
+	static uint64 grid_row_mask(int x0, int x1, int word) {
+		int b0 = MAX(x0 - (word << 6), 0);
+		int b1 = MIN(x1 - (word << 6), 64);
+		if (b0 >= b1) return 0;
+
+		uint64 mask = (b1 == 64) ? ~uint64(0) : ((uint64(1) << b1) - 1);
+		return mask & ~((uint64(1) << b0) - 1);
+	}
+
+	//! Слово строки сетки: клетки, у которых есть хотя бы один из атрибутов attr.
+	uint64 grid_plane_any(int attr, int offset) const {
+		uint64 bits = 0;
+		for (int i = 0; attr && i < GRID_PLANES_COUNT; i++, attr >>= 1) {
+			if (attr & 1)
+				bits |= _grid_planes[i][offset];
+		}
+		return bits;
+	}
+	//! Слово строки сетки: клетки, у которых есть все атрибуты attr.
+	uint64 grid_plane_all(int attr, int offset) const {
+		uint64 bits = ~uint64(0);
+		for (int i = 0; i < GRID_PLANES_COUNT; i++) {
+			if (attr & (1 << i))
+				bits &= _grid_planes[i][offset];
+		}
+		return bits;
+	}
+
+	//! Установка/снятие атрибутов attr у клеток, отмеченных в bits, слова word строки y.
+	void change_grid_word_attributes(int y, int word, uint64 bits, int attr, bool set);
+	//! Установка/снятие атрибутов attr у клеток [x0, x1) x [y0, y1).
+	void change_grid_rect_attributes(int x0, int y0, int x1, int y1, int attr, bool set);
+	//! Установка/снятие атрибутов attr у клеток, отмеченных в маске, см. set_grid_mask_attributes().
+	void change_grid_mask_attributes(const Vect2s &pos, const Vect2s &size, const uint64 *mask, int row_words, int attr, bool set);
+
+	//! Полный пересчет версии сетки.
+	void update_grid_version();
+
+	//! Обнуление счетчиков отпечатков, вызывается при пересоздании сетки.
+	void init_grid_footprints();
+	//! Клетки прямоугольника с центром center и размерами size, обрезанного по сетке.
+	void grid_rect(const Vect2s &center, const Vect2s &size, int &x0, int &y0, int &x1, int &y1) const;
+
+	//! Построение таблицы ближайших проходимых клеток (поиск в ширину от всех проходимых клеток).
+	void build_nearest_passable_cells() const;
 };
 
 inline Vect3f To3D(const Vect2f &v) {
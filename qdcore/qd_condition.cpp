@@ -28,6 +28,9 @@
 #include "qdengine/qdcore/qd_rnd.h"
 #include "qdengine/qdcore/qd_condition.h"
 #include "qdengine/qdcore/qd_game_dispatcher.h"
+#include "qdengine/qdcore/qd_game_object_animated.h"
+#include "qdengine/qdcore/qd_game_scene.h"
+#include "qdengine/qdcore/qd_grid_zone.h"
 
 namespace Common {
 class WriteStream;
@@ -38,10 +41,13 @@ namespace QDEngine {
 bool qdCondition::_successful_click = false;
 bool qdCondition::_successful_object_click = false;
 
-qdCondition::qdCondition() : _type(CONDITION_FALSE), _is_inversed(false), _is_in_group(false) {
+uint32 qdCondition::_base_generation = 1;
+uint32 qdCondition::_dependency_generations[qdCondition::DEPENDENCY_COUNT] = { 0, 0, 0 };
+
+qdCondition::qdCondition() : _type(CONDITION_FALSE), _is_inversed(false), _is_in_group(false), _check_stamp(0), _check_result(false) {
 }
 
-qdCondition::qdCondition(qdCondition::ConditionType tp) : _is_inversed(false), _is_in_group(false) {
+qdCondition::qdCondition(qdCondition::ConditionType tp) : _is_inversed(false), _is_in_group(false), _check_stamp(0), _check_result(false) {
 	set_type(tp);
 }
 
@@ -50,7 +56,9 @@ qdCondition::qdCondition(const qdCondition &cnd) : _type(cnd._type),
 	_data(cnd._data),
 	_objects(cnd._objects),
 	_is_inversed(cnd._is_inversed),
-	_is_in_group(false) {
+	_is_in_group(false),
+	_check_stamp(0),
+	_check_result(false) {
 }
 
 qdCondition &qdCondition::operator = (const qdCondition &cnd) {
@@ -64,6 +72,9 @@ qdCondition &qdCondition::operator = (const qdCondition &cnd) {
 
 	_is_inversed = cnd._is_inversed;
 
+	_check_stamp = 0;
+	_name_lookups.clear();
+
 	return *this;
 }
 
@@ -72,6 +83,8 @@ qdCondition::~qdCondition() {
 
 void qdCondition::set_type(ConditionType tp) {
 	_type = tp;
+	_check_stamp = 0;
+	_name_lookups.clear();
 
 	switch (_type) {
 	case CONDITION_TRUE:
@@ -273,16 +286,20 @@ void qdCondition::set_type(ConditionType tp) {
 
 bool qdCondition::put_value(int idx, const char *str) {
 	assert(idx >= 0 && idx < _data.size());
+	_check_stamp = 0;
+	_name_lookups.clear();
 	return _data[idx].put_string(str);
 }
 
 bool qdCondition::put_value(int idx, int val, int val_index) {
 	assert(idx >= 0 && idx < _data.size());
+	_check_stamp = 0;
 	return _data[idx].put_int(val, val_index);
 }
 
 bool qdCondition::put_value(int idx, float val, int val_index) {
 	assert(idx >= 0 && idx < _data.size());
+	_check_stamp = 0;
 	return _data[idx].put_float(val, val_index);
 }
 
@@ -377,6 +394,9 @@ void qdCondition::quant(float dt) {
 		if (!get_value(TIMER_PERIOD, period, 0)) return;
 		if (!get_value(TIMER_PERIOD, timer, 1)) return;
 
+		int prev_state = 0;
+		get_value(TIMER_RND, prev_state, 1);
+
 		timer += dt;
 
 		put_value(TIMER_PERIOD, timer, 1);
@@ -394,8 +414,13 @@ void qdCondition::quant(float dt) {
 				state = 0;
 
 			put_value(TIMER_RND, state, 1);
-		} else
+			if (state != prev_state)
+				touch_dependencies(DEPENDS_ON_TIMERS);
+		} else {
 			put_value(TIMER_RND, 0, 1);
+			if (prev_state)
+				touch_dependencies(DEPENDS_ON_TIMERS);
+		}
 	}
 }
 
@@ -410,6 +435,8 @@ bool qdCondition::load_data(Common::SeekableReadStream &fh, int save_version) {
 
 		if (!put_value(TIMER_PERIOD, timer, 1)) return false;
 		if (!put_value(TIMER_RND, state, 1)) return false;
+
+		touch_dependencies(DEPENDS_ON_TIMERS);
 	}
 
 	debugC(5, kDebugSave, "      qdCondition::load_data(): after %ld", fh.pos());
@@ -439,11 +466,18 @@ bool qdCondition::save_data(Common::WriteStream &fh) const {
 
 bool qdCondition::check() {
 	bool result = false;
-	if (qdGameDispatcher * dp = qdGameDispatcher::get_dispatcher()) {
+
+	uint32 stamp = dependencies_stamp(dependencies());
+	if (stamp && stamp == _check_stamp) {
+		result = _check_result;
+	} else if (qdGameDispatcher * dp = qdGameDispatcher::get_dispatcher()) {
 		if (dp->check_condition(this))
 			result = !_is_inversed;
 		else
 			result = _is_inversed;
+
+		_check_stamp = stamp;
+		_check_result = result;
 	}
 
 	if (result) {
@@ -459,6 +493,7 @@ bool qdCondition::check() {
 bool qdCondition::put_object(int idx, qdNamedObject *obj) {
 	assert(idx >= 0 && idx < _objects.size());
 	_objects[idx].set_object(obj);
+	_check_stamp = 0;
 	return true;
 }
 
@@ -473,12 +508,100 @@ const qdNamedObject *qdCondition::get_object(int idx) {
 	return NULL;
 }
 
+qdCondition::NameLookup *qdCondition::name_lookup(int idx, const qdNamedObject *context, const char *&name) {
+	if (idx < 0 || idx >= _data.size())
+		return NULL;
+
+	if (_name_lookups.size() != _data.size())
+		_name_lookups.resize(_data.size());
+
+	NameLookup &lookup = _name_lookups[idx];
+	if (lookup.stamp == _base_generation && lookup.context == context)
+		return &lookup;
+
+	lookup.stamp = _base_generation;
+	lookup.context = context;
+	lookup.object = NULL;
+
+	// По пустому имени ничего не ищется, результат тоже запоминается.
+	const char *str;
+	if (get_value(idx, str) && str && strlen(str))
+		name = str;
+
+	return &lookup;
+}
+
+const qdGameObject *qdCondition::find_game_object(int idx) {
+	const char *name = NULL;
+	NameLookup *lookup = name_lookup(idx, NULL, name);
+	if (!lookup)
+		return NULL;
+
+	if (name) {
+		if (qdGameDispatcher *dp = qdGameDispatcher::get_dispatcher())
+			lookup->object = dp->get_object(name);
+	}
+
+	return static_cast<const qdGameObject *>(lookup->object);
+}
+
+const qdGridZone *qdCondition::find_grid_zone(int idx, qdGameScene *scene) {
+	const char *name = NULL;
+	NameLookup *lookup = name_lookup(idx, scene, name);
+	if (!lookup)
+		return NULL;
+
+	if (name && scene)
+		lookup->object = scene->get_grid_zone(name);
+
+	return static_cast<const qdGridZone *>(lookup->object);
+}
+
+const qdGameObjectState *qdCondition::find_object_state(const qdGameObjectAnimated *obj, int idx) {
+	const char *name = NULL;
+	NameLookup *lookup = name_lookup(idx, obj, name);
+	if (!lookup)
+		return NULL;
+
+	if (name && obj)
+		lookup->object = obj->get_state(name);
+
+	return static_cast<const qdGameObjectState *>(lookup->object);
+}
 
 bool qdCondition::init() {
 	if (_type == CONDITION_TIMER) {
 		if (!put_value(TIMER_PERIOD, 0.0f, 1)) return false;
 		if (!put_value(TIMER_RND, 0, 1)) return false;
+
+		touch_dependencies(DEPENDS_ON_TIMERS);
 	}
 	return true;
 }
+
+int qdCondition::type_dependencies(ConditionType tp) {
+	switch (tp) {
+	case CONDITION_TRUE:
+	case CONDITION_FALSE:
+	case CONDITION_MINIGAME_STATE:
+		return 0;
+	case CONDITION_OBJECT_STATE:
+	case CONDITION_OBJECT_STATE_WAS_ACTIVATED:
+	case CONDITION_OBJECT_STATE_WAS_NOT_ACTIVATED:
+	case CONDITION_OBJECT_NOT_IN_STATE:
+	case CONDITION_OBJECT_STATE_WAITING:
+	case CONDITION_OBJECT_PREV_STATE:
+	case CONDITION_OBJECT_HIDDEN:
+		return DEPENDS_ON_OBJECT_STATES;
+	case CONDITION_COUNTER_GREATER_THAN_VALUE:
+	case CONDITION_COUNTER_LESS_THAN_VALUE:
+	case CONDITION_COUNTER_GREATER_THAN_COUNTER:
+	case CONDITION_COUNTER_IN_INTERVAL:
+		return DEPENDS_ON_COUNTERS;
+	case CONDITION_TIMER:
+		return DEPENDS_ON_TIMERS;
+	default:
+		return DEPENDS_ON_VOLATILE_DATA;
+	}
+}
 } // namespace QDEngine
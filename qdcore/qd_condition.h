@@ -33,6 +33,11 @@ class WriteStream;
 
 namespace QDEngine {
 
+class qdGameObject;
+class qdGameObjectAnimated;
+class qdGameObjectState;
+class qdGridZone;
+class qdGameScene;
 
 //! Условие.
 /**
@@ -480,6 +485,22 @@ public:
 		STATE_TIME = 2
 	};
 
+	//! Данные, от которых зависит результат проверки условия.
+	/**
+	Результат проверки условия запоминается и пересчитывается только
+	после изменения данных, от которых оно зависит (см. touch_dependencies()).
+	*/
+	enum ConditionDependency {
+		//! состояния объектов и их видимость
+		DEPENDS_ON_OBJECT_STATES = 0x01,
+		//! значения счетчиков
+		DEPENDS_ON_COUNTERS = 0x02,
+		//! срабатывания таймеров
+		DEPENDS_ON_TIMERS = 0x04,
+		//! данные, изменения которых не отслеживаются (мышь, клавиатура, координаты, время) - условие проверяется каждый раз
+		DEPENDS_ON_VOLATILE_DATA = 0x80
+	};
+
 	qdCondition();
 	qdCondition(ConditionType tp);
 	qdCondition(const qdCondition &cnd);
@@ -492,6 +513,45 @@ public:
 	}
 	void set_type(ConditionType tp);
 
+	//! Возвращает комбинацию ConditionDependency для условий типа tp.
+	static int type_dependencies(ConditionType tp);
+	//! Возвращает комбинацию ConditionDependency.
+	int dependencies() const {
+		return type_dependencies(_type);
+	}
+
+	//! Отмечает изменение данных, от которых зависят условия.
+	static void touch_dependencies(int dependency_flags) {
+		for (int i = 0; i < DEPENDENCY_COUNT; i++) {
+			if (dependency_flags & (1 << i))
+				_dependency_generations[i]++;
+		}
+	}
+	//! Сбрасывает запомненные результаты проверки всех условий и поиска объектов по имени.
+	/**
+	Вызывается при смене сцены, загрузке сэйва и изменении списков состояний объектов.
+	*/
+	static void invalidate_all() {
+		_base_generation++;
+	}
+	//! Возвращает отметку о версии данных, от которых зависят условия.
+	/**
+	Отметка меняется при любом изменении этих данных,
+	0 - если среди зависимостей есть DEPENDS_ON_VOLATILE_DATA.
+	*/
+	static uint32 dependencies_stamp(int dependency_flags) {
+		if (dependency_flags & DEPENDS_ON_VOLATILE_DATA)
+			return 0;
+
+		uint32 stamp = _base_generation;
+		for (int i = 0; i < DEPENDENCY_COUNT; i++) {
+			if (dependency_flags & (1 << i))
+				stamp += _dependency_generations[i];
+		}
+
+		return stamp;
+	}
+
 	bool put_value(int idx, const char *str);
 
 	bool is_click_condition() const {
@@ -513,6 +573,17 @@ public:
 	bool put_object(int idx, qdNamedObject *obj);
 	const qdNamedObject *get_object(int idx) ;
 
+	//! Поиск объекта активной сцены по имени из строки idx в данных условия.
+	/**
+	Найденные указатели запоминаются и сбрасываются при смене
+	сцены и загрузке сэйва (см. invalidate_all()).
+	*/
+	const qdGameObject *find_game_object(int idx);
+	//! Поиск зоны на сетке сцены scene по имени из строки idx, см. find_game_object().
+	const qdGridZone *find_grid_zone(int idx, qdGameScene *scene);
+	//! Поиск состояния объекта obj по имени из строки idx, см. find_game_object().
+	const qdGameObjectState *find_object_state(const qdGameObjectAnimated *obj, int idx);
+
 	const qdNamedObject *owner() const {
 		return _owner;
 	}
@@ -538,6 +609,7 @@ public:
 	}
 	void inverse(bool inverse_mode = true) {
 		_is_inversed = inverse_mode;
+		_check_stamp = 0;
 	}
 
 	bool check();
@@ -580,6 +652,40 @@ private:
 	static bool _successful_click;
 	static bool _successful_object_click;
 
+	//! Запомненный результат поиска объекта по имени.
+	struct NameLookup {
+		NameLookup() : stamp(0), context(NULL), object(NULL) { }
+
+		//! Значение _base_generation на момент поиска, 0 - поиска не было.
+		uint32 stamp;
+		//! Объект, в котором производился поиск.
+		const qdNamedObject *context;
+		const qdNamedObject *object;
+	};
+
+	typedef Std::vector<NameLookup> name_lookups_container_t;
+	//! Результаты поиска по индексам в _data.
+	name_lookups_container_t _name_lookups;
+
+	//! Возвращает результат поиска для строки idx.
+	/**
+	Если поиск надо повторить, результат сбрасывается и в name
+	возвращается имя для поиска, иначе name не меняется.
+	*/
+	NameLookup *name_lookup(int idx, const qdNamedObject *context, const char *&name);
+
+	//! Отметка о версии данных на момент последней проверки условия, 0 - результата нет.
+	uint32 _check_stamp;
+	//! Результат последней проверки условия.
+	bool _check_result;
+
+	enum {
+		DEPENDENCY_COUNT = 3
+	};
+
+	static uint32 _base_generation;
+	static uint32 _dependency_generations[DEPENDENCY_COUNT];
+
 	bool init_data(int data_index, qdConditionData::data_t data_type, int data_size = 0) {
 		assert(data_index >= 0 && data_index < _data.size());
 
@@ -27,18 +27,25 @@
 #include "qdengine/parser/qdscr_parser.h"
 #include "qdengine/qdcore/qd_conditional_object.h"
 #include "qdengine/qdcore/qd_game_scene.h"
+#include "qdengine/qdcore/util/profiler.h"
 
 
 namespace QDEngine {
 
 
-qdConditionalObject::qdConditionalObject() : _conditions_mode(CONDITIONS_OR) {
+qdConditionalObject::qdConditionalObject() : _conditions_mode(CONDITIONS_OR),
+	_conditions_dependencies(-1),
+	_conditions_stamp(0),
+	_conditions_result(false) {
 }
 
 qdConditionalObject::qdConditionalObject(const qdConditionalObject &obj) : qdNamedObject(obj),
 	_conditions_mode(obj._conditions_mode),
 	_conditions(obj._conditions),
-	_condition_groups(obj._condition_groups) {
+	_condition_groups(obj._condition_groups),
+	_conditions_dependencies(-1),
+	_conditions_stamp(0),
+	_conditions_result(false) {
 }
 
 qdConditionalObject::~qdConditionalObject() {
@@ -53,13 +60,32 @@ qdConditionalObject &qdConditionalObject::operator = (const qdConditionalObject
 	_conditions = obj._conditions;
 	_condition_groups = obj._condition_groups;
 
+	conditions_changed();
+
 	return *this;
 }
 
+void qdConditionalObject::conditions_changed() {
+	_conditions_dependencies = -1;
+	_conditions_stamp = 0;
+}
+
+int qdConditionalObject::conditions_dependencies() {
+	if (_conditions_dependencies == -1) {
+		_conditions_dependencies = 0;
+		for (auto &it : _conditions)
+			_conditions_dependencies |= it.dependencies();
+	}
+
+	return _conditions_dependencies;
+}
+
 int qdConditionalObject::add_condition(const qdCondition *p) {
 	_conditions.push_back(*p);
 	_conditions.back().set_owner(this);
 
+	conditions_changed();
+
 	return _conditions.size() - 1;
 }
 
@@ -70,12 +96,28 @@ bool qdConditionalObject::update_condition(int num, const qdCondition &p) {
 	cond = p;
 	cond.set_owner(this);
 
+	conditions_changed();
+
 	return true;
 }
 
 bool qdConditionalObject::check_conditions() {
 	qdCondition::clear_successful_clicks();
 
+	// Пока не изменились данные, от которых зависят условия, результат проверки тот же.
+	uint32 stamp = qdCondition::dependencies_stamp(conditions_dependencies());
+	if (stamp && stamp == _conditions_stamp)
+		return _conditions_result;
+
+	_conditions_result = evaluate_conditions();
+	_conditions_stamp = stamp;
+
+	return _conditions_result;
+}
+
+bool qdConditionalObject::evaluate_conditions() {
+	QD_PROFILE_SCOPE(PROFILE_CONDITIONS);
+
 	if (!_conditions.empty()) {
 		switch (conditions_mode()) {
 		case CONDITIONS_AND:
@@ -116,6 +158,8 @@ bool qdConditionalObject::remove_conditon(int idx) {
 	for (condition_groups_container_t::iterator it = _condition_groups.begin(); it != _condition_groups.end(); ++it)
 		it->remove_condition(idx);
 
+	conditions_changed();
+
 	return true;
 }
 
@@ -168,6 +212,8 @@ bool qdConditionalObject::load_conditions_script(const xml::tag *p) {
 			_conditions[i].add_group_reference();
 	}
 
+	conditions_changed();
+
 	return true;
 }
 
@@ -192,8 +238,15 @@ bool qdConditionalObject::save_conditions_script(Common::WriteStream &fh, int in
 }
 
 void qdConditionalObject::conditions_quant(float dt) {
+	// Обсчитывать в условиях нужно только таймеры.
+	if (!(conditions_dependencies() & qdCondition::DEPENDS_ON_TIMERS))
+		return;
+
+	// dt добавляется к таймерам каждый квант: если суммировать его заранее,
+	// из-за округления таймер может сработать на соседнем кванте.
 	for (auto &it : _conditions) {
-		it.quant(dt);
+		if (it.type() == qdCondition::CONDITION_TIMER)
+			it.quant(dt);
 	}
 }
 
@@ -205,6 +258,8 @@ bool qdConditionalObject::load_data(Common::SeekableReadStream &fh, int save_ver
 	for (auto &it : _conditions)
 		it.load_data(fh, save_version);
 
+	conditions_changed();
+
 	debugC(4, kDebugSave, "    qdConditionalObject::load_data(): after %ld", fh.pos());
 	return true;
 }
@@ -252,6 +307,7 @@ bool qdConditionalObject::is_condition_in_group(int condition_idx) const {
 
 int qdConditionalObject::add_condition_group(const qdConditionGroup *p) {
 	_condition_groups.push_back(*p);
+	conditions_changed();
 	return _condition_groups.size() - 1;
 }
 
@@ -268,6 +324,8 @@ bool qdConditionalObject::update_condition_group(int num, const qdConditionGroup
 			_conditions[i].remove_group_reference();
 	}
 
+	conditions_changed();
+
 	return true;
 }
 
@@ -283,6 +341,8 @@ bool qdConditionalObject::remove_conditon_group(int idx) {
 			_conditions[i].remove_group_reference();
 	}
 
+	conditions_changed();
+
 	return true;
 }
 
@@ -295,6 +355,8 @@ bool qdConditionalObject::init() {
 			result = false;
 	}
 
+	conditions_changed();
+
 	return result;
 }
 
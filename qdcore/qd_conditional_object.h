@@ -155,7 +155,20 @@ private:
 	//! Группы условий.
 	condition_groups_container_t _condition_groups;
 
+	//! Объединение qdCondition::dependencies() всех условий, -1 - не посчитано.
+	int _conditions_dependencies;
+	//! Отметка о версии данных на момент последней проверки условий, 0 - результата нет.
+	uint32 _conditions_stamp;
+	//! Результат последней проверки условий.
+	bool _conditions_result;
+
 	bool check_group_conditions(const qdConditionGroup &gr);
+	bool evaluate_conditions();
+
+	//! Сброс запомненного результата проверки условий, вызывается при их изменении.
+	void conditions_changed();
+	//! Возвращает объединение qdCondition::dependencies() всех условий.
+	int conditions_dependencies();
 };
 
 } // namespace QDEngine
@@ -19,6 +19,8 @@
  *
  */
 
+#include "common/algorithm.h"
+
 #include "qdengine/qd_fwd.h"
 #include "qdengine/parser/qdscr_parser.h"
 #include "qdengine/parser/xml_tag_buffer.h"
@@ -169,6 +171,79 @@ bool qdContour::is_inside(const Vect2s &pos) const {
 return false;
 }
 
+bool qdContour::rasterize(Std::vector<uint64> &mask, int &row_words) const {
+	if (_contour_type != CONTOUR_POLYGON || _contour.empty())
+		return false;
+
+	int x0 = _mask_pos.x - _size.x / 2;
+	int y0 = _mask_pos.y - _size.y / 2;
+
+	row_words = (_size.x + 63) / 64;
+
+	mask.clear();
+	mask.resize(row_words * _size.y, 0);
+
+	// Пересечения строки с ребрами - отдельно для двух вариантов
+	// полуоткрытых интервалов по y, так же, как в is_inside().
+	Std::vector<int> isect0;
+	Std::vector<int> isect1;
+
+	for (int y = 0; y < _size.y; y++) {
+		int py = y0 + y;
+
+		isect0.clear();
+		isect1.clear();
+
+		for (int i = 0; i < _contour.size(); i++) {
+			Vect2s p0 = _contour[i];
+			Vect2s p1 = (i < _contour.size() - 1) ? _contour[i + 1] : _contour[0];
+			if (p0.y == p1.y)
+				continue;
+
+			bool cross0 = (p0.y < py && p1.y >= py) || (p0.y >= py && p1.y < py);
+			bool cross1 = (p0.y <= py && p1.y > py) || (p0.y > py && p1.y <= py);
+			if (!cross0 && !cross1)
+				continue;
+
+			int x = (py - p0.y) * (p1.x - p0.x) / (p1.y - p0.y) + p0.x;
+			if (cross0)
+				isect0.push_back(x);
+			if (cross1)
+				isect1.push_back(x);
+		}
+
+		if (isect0.empty() && isect1.empty())
+			continue;
+
+		Common::sort(isect0.begin(), isect0.end());
+		Common::sort(isect1.begin(), isect1.end());
+
+		uint64 *row = &mask[y * row_words];
+
+		int lt0 = 0;
+		int lt1 = 0;
+		for (int x = 0; x < _size.x; x++) {
+			int px = x0 + x;
+
+			while (lt0 < isect0.size() && isect0[lt0] < px)
+				lt0++;
+			while (lt1 < isect1.size() && isect1[lt1] < px)
+				lt1++;
+
+			bool inside;
+			if ((lt0 < isect0.size() && isect0[lt0] == px) || (lt1 < isect1.size() && isect1[lt1] == px))
+				inside = true;
+			else
+				inside = ((lt0 & 1) && lt0 < isect0.size()) || ((lt1 & 1) && lt1 < isect1.size());
+
+			if (inside)
+				row[x >> 6] |= uint64(1) << (x & 63);
+		}
+	}
+
+	return true;
+}
+
 bool qdContour::save_script(Common::WriteStream &fh, int indent) const {
 	if (_contour_type == CONTOUR_POLYGON) {
 		for (int i = 0; i < indent; i++) {
@@ -136,6 +136,15 @@ public:
 
 	bool update_contour();
 
+	//! Растеризует многоугольник в битовую маску.
+	/**
+	Бит x строки y маски соответствует точке mask_pos() - mask_size() / 2 + (x, y),
+	бит выставлен, если для этой точки is_inside() возвращает true.
+	Каждая строка маски занимает row_words 64-битных слов.
+	Работает только для CONTOUR_POLYGON.
+	*/
+	bool rasterize(Std::vector<uint64> &mask, int &row_words) const;
+
 	// можно ли замкнуть текущий контур.
 	// для типов контура CONTOUR_CIRCLE и CONTOUR_RECTANGLE
 	// всегда возвращается false
@@ -26,7 +26,9 @@
 #include "qdengine/qd_fwd.h"
 #include "qdengine/parser/xml_tag_buffer.h"
 #include "qdengine/parser/qdscr_parser.h"
+#include "qdengine/qdcore/qd_condition.h"
 #include "qdengine/qdcore/qd_counter.h"
+#include "qdengine/qdcore/qd_game_dispatcher.h"
 #include "qdengine/qdcore/qd_game_object_state.h"
 
 
@@ -34,7 +36,8 @@ namespace QDEngine {
 
 qdCounterElement::qdCounterElement() : _state(NULL),
 	_last_state_status(false),
-	_increment_value(true) {
+	_increment_value(true),
+	_activation_changed(true) {
 }
 
 qdCounterElement::~qdCounterElement() {
@@ -43,7 +46,8 @@ qdCounterElement::~qdCounterElement() {
 qdCounterElement::qdCounterElement(const qdGameObjectState *p, bool inc_value) : _state(p),
 	_state_reference(p),
 	_last_state_status(false),
-	_increment_value(inc_value) {
+	_increment_value(inc_value),
+	_activation_changed(true) {
 }
 
 bool qdCounterElement::init() {
@@ -56,11 +60,17 @@ bool qdCounterElement::init() {
 //	}
 
 	_last_state_status = false;
+	_activation_changed = true;
 
 	return true;
 }
 
 bool qdCounterElement::quant() {
+	if (!_activation_changed)
+		return false;
+
+	_activation_changed = false;
+
 	if (_state) {
 		bool result = false;
 
@@ -121,6 +131,7 @@ bool qdCounterElement::load_data(Common::SeekableReadStream &fh, int save_versio
 	char v;
 	v = fh.readByte();
 	_last_state_status = v;
+	_activation_changed = true;
 	return true;
 }
 
@@ -130,13 +141,16 @@ bool qdCounterElement::save_data(Common::WriteStream &fh) const {
 }
 
 qdCounter::qdCounter() : _value(0),
-	_value_limit(0) {
+	_value_limit(0),
+	_has_changed_elements(true) {
 }
 
 qdCounter::~qdCounter() {
 }
 
 void qdCounter::set_value(int value) {
+	int prev_value = _value;
+
 	_value = value;
 
 	if (_value_limit > 0 && _value >= _value_limit)
@@ -144,9 +158,14 @@ void qdCounter::set_value(int value) {
 
 	if (check_flag(POSITIVE_VALUE) && _value < 0)
 		_value = 0;
+
+	if (_value != prev_value)
+		qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_COUNTERS);
 }
 
 void qdCounter::add_value(int value_delta) {
+	int prev_value = _value;
+
 	_value += value_delta;
 
 	if (_value_limit > 0 && _value >= _value_limit)
@@ -154,6 +173,9 @@ void qdCounter::add_value(int value_delta) {
 
 	if (check_flag(POSITIVE_VALUE) && _value < 0)
 		_value = 0;
+
+	if (_value != prev_value)
+		qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_COUNTERS);
 }
 
 bool qdCounter::add_element(const qdGameObjectState *p, bool inc_value) {
@@ -162,6 +184,11 @@ bool qdCounter::add_element(const qdGameObjectState *p, bool inc_value) {
 		return false;
 
 	_elements.push_back(qdCounterElement(p, inc_value));
+	_has_changed_elements = true;
+
+	if (qdGameDispatcher *dp = qdGameDispatcher::get_dispatcher())
+		dp->counters_changed();
+
 	return true;
 }
 
@@ -169,6 +196,10 @@ bool qdCounter::remove_element(const qdGameObjectState *p) {
 	element_container_t::iterator it = Common::find(_elements.begin(), _elements.end(), p);
 	if (it != _elements.end()) {
 		_elements.erase(it);
+
+		if (qdGameDispatcher *dp = qdGameDispatcher::get_dispatcher())
+			dp->counters_changed();
+
 		return true;
 	}
 
@@ -179,10 +210,35 @@ bool qdCounter::remove_element(int idx) {
 	assert(idx >= 0 && idx < _elements.size());
 
 	_elements.erase(_elements.begin() + idx);
+
+	if (qdGameDispatcher *dp = qdGameDispatcher::get_dispatcher())
+		dp->counters_changed();
+
 	return true;
 }
 
+void qdCounter::state_activation_changed(const qdGameObjectState *p) {
+	for (element_container_t::iterator it = _elements.begin(); it != _elements.end(); ++it) {
+		if (it->state() == p) {
+			it->set_activation_changed();
+			_has_changed_elements = true;
+		}
+	}
+}
+
+void qdCounter::check_all_elements() {
+	for (element_container_t::iterator it = _elements.begin(); it != _elements.end(); ++it)
+		it->set_activation_changed();
+
+	_has_changed_elements = true;
+}
+
 void qdCounter::quant() {
+	if (!_has_changed_elements)
+		return;
+
+	_has_changed_elements = false;
+
 	int value_change = 0;
 	for (element_container_t::iterator it = _elements.begin(); it != _elements.end(); ++it) {
 		if (it->quant()) {
@@ -193,6 +249,8 @@ void qdCounter::quant() {
 		}
 	}
 
+	int prev_value = _value;
+
 	_value += value_change;
 
 	if (_value_limit > 0 && _value >= _value_limit)
@@ -200,6 +258,9 @@ void qdCounter::quant() {
 
 	if (check_flag(POSITIVE_VALUE) && _value < 0)
 		_value = 0;
+
+	if (_value != prev_value)
+		qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_COUNTERS);
 }
 
 bool qdCounter::load_script(const xml::tag *p) {
@@ -281,6 +342,9 @@ bool qdCounter::load_data(Common::SeekableReadStream &fh, int save_version) {
 	for (auto &it : _elements)
 		it.load_data(fh, save_version);
 
+	_has_changed_elements = true;
+	qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_COUNTERS);
+
 	debugC(3, kDebugSave, "  qdCounter::load_data(): after %ld", fh.pos());
 	return true;
 }
@@ -302,7 +366,9 @@ void qdCounter::init() {
 	for (element_container_t::iterator it = _elements.begin(); it != _elements.end(); ++it)
 		it->init();
 
+	_has_changed_elements = true;
 	_value = 0;
+	qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_COUNTERS);
 }
 
 } // namespace QDEngine
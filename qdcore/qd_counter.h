@@ -51,8 +51,18 @@ public:
 	}
 
 	bool init();
+	//! Проверка включения состояния, возвращает true, если состояние включилось.
+	/**
+	Состояние проверяется, только если после предыдущей проверки
+	оно могло включиться или выключиться, см. set_activation_changed().
+	*/
 	bool quant();
 
+	//! Отмечает, что активность состояния могла измениться.
+	void set_activation_changed() {
+		_activation_changed = true;
+	}
+
 	bool load_script(const xml::tag *p);
 	bool save_script(Common::WriteStream &fh, int indent = 0) const;
 
@@ -67,6 +77,8 @@ private:
 	const qdGameObjectState *_state;
 	bool _last_state_status;
 	bool _increment_value;
+	//! true, если состояние надо проверить в quant().
+	bool _activation_changed;
 };
 
 //! Счетчик состояний.
@@ -111,6 +123,11 @@ public:
 
 	void quant();
 
+	//! Уведомление о том, что состояние p включилось или выключилось.
+	void state_activation_changed(const qdGameObjectState *p);
+	//! Отмечает все элементы счетчика для проверки в quant().
+	void check_all_elements();
+
 	void init();
 
 	bool load_script(const xml::tag *p);
@@ -134,6 +151,9 @@ private:
 	Если меньше или равно нулю - не учитывается.
 	*/
 	int _value_limit;
+
+	//! true, если есть элементы, отмеченные для проверки в quant().
+	bool _has_changed_elements;
 };
 
 } // namespace QDEngine
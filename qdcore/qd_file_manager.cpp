@@ -140,6 +140,10 @@ bool qdFileManager::open_file(Common::SeekableReadStream **fh, const char *file_
 	return false;
 }
 
+bool qdFileManager::is_packed_file(const char *file_name) const {
+	return !SearchMan.hasFile(Common::Path(file_name));
+}
+
 bool qdFileManager::is_package_available(const qdFileOwner &file_owner) {
 	return true;
 }
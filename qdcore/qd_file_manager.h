@@ -71,6 +71,11 @@ public:
 	void enable_packages() {}
 
 	bool open_file(Common::SeekableReadStream **fh, const char *file_name, bool err_message = true);
+	//! Возвращает true, если open_file() откроет файл не с диска, а из пакета.
+	/**
+	Файлы из пакетов открываются потоками в памяти.
+	*/
+	bool is_packed_file(const char *file_name) const;
 
 	int last_CD_id() const {
 		return 1;
@@ -33,6 +33,8 @@
 #include "qdengine/parser/xml_parser.h"
 
 #include "qdengine/qdcore/util/plaympp_api.h"
+#include "qdengine/qdcore/util/profiler.h"
+#include "qdengine/qdcore/util/trace_recorder.h"
 #include "qdengine/qdcore/qd_game_dispatcher.h"
 #include "qdengine/qdcore/qd_textdb.h"
 #include "qdengine/qdcore/qd_sound.h"
@@ -110,6 +112,15 @@ qdGameDispatcher::qdGameDispatcher() : _is_paused(false),
 
 	_autosave_slot = 0;
 
+	_counter_index_valid = false;
+
+	_quant_index = 0;
+
+	_quant_since_redraw = true;
+	_redraw_mouse_pos = Vect2i(-1, -1);
+
+	_memory_budget_exceeded = false;
+
 	_interface_music_mode = false;
 
 	_dialog_states.reserve(16);
@@ -159,6 +170,12 @@ void qdGameDispatcher::update_time() {
 
 void qdGameDispatcher::quant() {
 	debugC(9, kDebugQuant, "qdGameDispatcher::quant()");
+	QD_TRACE_SCOPE("quant");
+
+	uint32 start_time = g_system->getMillis();
+
+	_quant_index++;
+	_quant_since_redraw = true;
 
 	if (check_flag(SKIP_REDRAW_FLAG)) {
 		debugC(3, kDebugQuant, "qdGameDispatcher::quant() Skipping redraw...");
@@ -208,10 +225,14 @@ void qdGameDispatcher::quant() {
 		end_game(_game_end);
 		_game_end = NULL;
 	}
+
+	qdGameScene::fps_counter()->add_logic_time(g_system->getMillis() - start_time);
 }
 
 void qdGameDispatcher::quant(float dt) {
 	debugC(9, kDebugQuant, "qdGameDispatcher::quant(%f)", dt);
+	QD_PROFILE_SCOPE(PROFILE_DISPATCHER_QUANT);
+
 	if (sndDispatcher * snd = sndDispatcher::get_dispatcher()) {
 		snd->quant();
 	}
@@ -254,6 +275,9 @@ void qdGameDispatcher::quant(float dt) {
 			it->quant(dt);
 		}
 
+		if (!_counter_index_valid)
+			build_counter_index();
+
 		for (qdCounterList::const_iterator it = counter_list().begin(); it != counter_list().end(); ++it)
 			(*it)->quant();
 
@@ -291,7 +315,8 @@ void qdGameDispatcher::quant(float dt) {
 		drop_flag(NEXT_FRAME_FLAG);
 	} else {
 		if (is_video_playing()) {
-			if (is_video_finished()) {
+			// При ускоренной прокрутке видео пропускается целиком
+			if (is_video_finished() || g_engine->_fastForwardQuants) {
 				close_video();
 			} else {
 				continueVideo();
@@ -723,13 +748,29 @@ void qdGameDispatcher::post_redraw() {
 
 //#define _GD_REDRAW_REGIONS_CHECK_
 
-void qdGameDispatcher::redraw() {
-	_mouse_obj->set_pos(Vect3f(mouseDispatcher::instance()->mouse_x(), mouseDispatcher::instance()->mouse_y(), 0));
+bool qdGameDispatcher::redraw() {
+	Vect2i mouse_pos(mouseDispatcher::instance()->mouse_x(), mouseDispatcher::instance()->mouse_y());
+	if (!_quant_since_redraw && mouse_pos == _redraw_mouse_pos && !need_full_redraw() && !is_video_playing())
+		return false;
+
+	QD_PROFILE_SCOPE(PROFILE_REDRAW);
+	QD_TRACE_SCOPE("redraw");
+
+	uint32 start_time = g_system->getMillis();
+
+	_quant_since_redraw = false;
+	_redraw_mouse_pos = mouse_pos;
+
+	_mouse_obj->set_pos(Vect3f(mouse_pos.x, mouse_pos.y, 0));
 	_mouse_obj->update_screen_pos();
 
+	bool screen_changed = false;
+
 	if (!check_flag(SKIP_REDRAW_FLAG)) {
 		if (!is_video_playing()) {
 			pre_redraw();
+
+			screen_changed = !grDispatcher::instance()->changed_regions().empty();
 #ifndef _GD_REDRAW_REGIONS_CHECK_
 			for (grDispatcher::region_iterator it = grDispatcher::instance()->changed_regions().begin(); it != grDispatcher::instance()->changed_regions().end(); ++it) {
 				if (!it->is_empty())
@@ -745,11 +786,17 @@ void qdGameDispatcher::redraw() {
 
 			grDispatcher::instance()->flush();
 #endif
-		}
+		} else
+			screen_changed = true;
+
 		if (!qdGameConfig::get_config().force_full_redraw())
 			drop_flag(FULLSCREEN_REDRAW_FLAG);
 		post_redraw();
 	}
+
+	qdGameScene::fps_counter()->add_redraw_time(g_system->getMillis() - start_time);
+
+	return screen_changed;
 }
 
 void qdGameDispatcher::redraw(const grScreenRegion &reg) {
@@ -897,6 +944,17 @@ int qdGameDispatcher::get_resources_size() {
 
 qdNamedObject *qdGameDispatcher::get_named_object(const qdNamedObjectReference *ref) {
 	qdNamedObject *p = nullptr;
+	if (ref->cached_object(p))
+		return p;
+
+	p = find_named_object(ref);
+	ref->set_cached_object(p);
+
+	return p;
+}
+
+qdNamedObject *qdGameDispatcher::find_named_object(const qdNamedObjectReference *ref) {
+	qdNamedObject *p = nullptr;
 
 	for (int i = 0; i < ref->num_levels(); i++) {
 		debugC(9, kDebugLoad, "%i of %d: type: %s (%d)  p so far: %p", i, ref->num_levels() - 1, objectType2str(ref->object_type(i)), ref->object_type(i), (void *)p);
@@ -1049,7 +1107,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 					if (cnd->owner())
 						p = cnd->owner()->owner();
 				} else
-					p = get_object(object_name);
+					p = cnd->find_game_object(qdCondition::OBJECT_NAME);
 
 				if (!p) return false;
 			}
@@ -1102,7 +1160,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 					if (cnd->owner())
 						p = cnd->owner()->owner();
 				} else
-					p = get_object(object_name);
+					p = cnd->find_game_object(qdCondition::OBJECT_NAME);
 
 				if (!p) return false;
 			}
@@ -1117,7 +1175,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 					if (!cnd->get_value(qdCondition::MOUSE_OBJECT_NAME, object_name) || !strlen(object_name))
 						return false;
 
-					m_obj = get_object(object_name);
+					m_obj = cnd->find_game_object(qdCondition::MOUSE_OBJECT_NAME);
 					if (!m_obj) return false;
 				}
 
@@ -1157,7 +1215,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 				if (cnd->owner())
 					obj = dynamic_cast<const qdGameObject * >(cnd->owner()->owner());
 			} else
-				obj = get_object(object_name);
+				obj = cnd->find_game_object(qdCondition::OBJECT_NAME);
 
 			if (!obj) return false;
 		}
@@ -1178,7 +1236,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 			if (!cnd->get_value(qdCondition::ZONE_NAME, zone_name))
 				return false;
 
-			zone = sc->get_grid_zone(zone_name);
+			zone = cnd->find_grid_zone(qdCondition::ZONE_NAME, sc);
 		}
 
 		if (!zone) return false;
@@ -1193,7 +1251,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 				if (!cnd->owner() || !cnd->owner()->owner()) return false;
 				p = dynamic_cast<const qdGameObjectMoving *>(cnd->owner()->owner());
 			} else
-				p = dynamic_cast<const qdGameObjectMoving *>(get_object(object_name));
+				p = dynamic_cast<const qdGameObjectMoving *>(cnd->find_game_object(qdCondition::PERSONAGE_NAME));
 
 			if (!p) return false;
 		}
@@ -1220,7 +1278,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 				if (!cnd->owner() || !cnd->owner()->owner()) return false;
 				p = dynamic_cast<const qdGameObjectMoving *>(cnd->owner()->owner());
 			} else
-				p = dynamic_cast<const qdGameObjectMoving *>(get_object(object_name));
+				p = dynamic_cast<const qdGameObjectMoving *>(cnd->find_game_object(qdCondition::PERSONAGE_NAME));
 
 			if (!p) return false;
 		}
@@ -1261,7 +1319,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 				if (cnd->owner())
 					obj = dynamic_cast<const qdGameObject * >(cnd->owner()->owner());
 			} else
-				obj = get_object(object_name);
+				obj = cnd->find_game_object(qdCondition::OBJECT_NAME);
 
 			if (!obj) return false;
 		}
@@ -1302,7 +1360,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 				if (!cnd->get_value(qdCondition::CLICK_ZONE_NAME, zone_name))
 					return false;
 
-				zone = sc->get_grid_zone(zone_name);
+				zone = cnd->find_grid_zone(qdCondition::CLICK_ZONE_NAME, sc);
 				if (!zone) return false;
 			}
 
@@ -1329,7 +1387,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 				if (!cnd->get_value(qdCondition::CLICK_ZONE_NAME, zone_name))
 					return false;
 
-				zone = sc->get_grid_zone(zone_name);
+				zone = cnd->find_grid_zone(qdCondition::CLICK_ZONE_NAME, sc);
 				if (!zone) return false;
 			}
 
@@ -1340,7 +1398,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 					if (!cnd->get_value(qdCondition::MOUSE_OBJECT_NAME, object_name) || !strlen(object_name))
 						return false;
 
-					m_obj = get_object(object_name);
+					m_obj = cnd->find_game_object(qdCondition::MOUSE_OBJECT_NAME);
 					if (!m_obj) return false;
 				}
 
@@ -1357,7 +1415,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 				if (cnd->owner())
 					obj = static_cast<const qdGameObject * >(cnd->owner()->owner());
 			} else
-				obj = get_object(object_name);
+				obj = cnd->find_game_object(qdCondition::OBJECT_NAME);
 
 			if (!obj) return false;
 		}
@@ -1366,11 +1424,8 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 			if (const qdGameObjectState * sp = static_cast<const qdGameObjectState * >(cnd->get_object(qdCondition::OBJECT_STATE_NAME))) {
 				return p->was_state_active(sp);
 			} else {
-				const char *state_name;
-				if (!cnd->get_value(qdCondition::OBJECT_STATE_NAME, state_name) || !strlen(state_name))
-					return false;
-
-				return p->was_state_active(state_name);
+				const qdGameObjectState *state = cnd->find_object_state(p, qdCondition::OBJECT_STATE_NAME);
+				return state && p->was_state_active(state);
 			}
 		}
 	}
@@ -1381,7 +1436,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 		const qdGameObject *obj1 = dynamic_cast<const qdGameObject *>(cnd->get_object(qdCondition::OBJECT_NAME));
 		if (!obj1) {
 			if (cnd->get_value(qdCondition::OBJECT_NAME, object_name) && strlen(object_name))
-				obj1 = get_object(object_name);
+				obj1 = cnd->find_game_object(qdCondition::OBJECT_NAME);
 			if (!obj1) return false;
 		}
 
@@ -1391,7 +1446,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 		const qdGameObject *obj2 = dynamic_cast<const qdGameObject *>(cnd->get_object(qdCondition::OBJECT2_NAME));
 		if (!obj2) {
 			if (cnd->get_value(qdCondition::OBJECT2_NAME, object_name) && strlen(object_name))
-				obj2 = get_object(object_name);
+				obj2 = cnd->find_game_object(qdCondition::OBJECT2_NAME);
 			if (!obj2) return false;
 		}
 
@@ -1416,7 +1471,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 					if (!cnd->owner() || !cnd->owner()->owner()) return false;
 					p = dynamic_cast<const qdGameObjectMoving *>(cnd->owner()->owner());
 				} else
-					p = dynamic_cast<const qdGameObjectMoving *>(get_object(object_name));
+					p = dynamic_cast<const qdGameObjectMoving *>(cnd->find_game_object(qdCondition::PERSONAGE_NAME));
 
 				if (!p) return false;
 			}
@@ -1432,7 +1487,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 				if (cnd->owner())
 					obj = dynamic_cast<const qdGameObject * >(cnd->owner()->owner());
 			} else
-				obj = get_object(object_name);
+				obj = cnd->find_game_object(qdCondition::OBJECT_NAME);
 
 			if (!obj) return false;
 		}
@@ -1461,7 +1516,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 				if (cnd->owner())
 					obj = dynamic_cast<const qdGameObject * >(cnd->owner()->owner());
 			} else
-				obj = get_object(object_name);
+				obj = cnd->find_game_object(qdCondition::OBJECT_NAME);
 
 			if (!obj) return false;
 		}
@@ -1472,11 +1527,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 
 			const qdGameObjectState *sp = dynamic_cast<const qdGameObjectState *>(cnd->get_object(qdCondition::OBJECT_STATE_NAME));
 			if (!sp) {
-				const char *state_name;
-				if (!cnd->get_value(qdCondition::OBJECT_STATE_NAME, state_name) || !strlen(state_name))
-					return false;
-
-				sp = p->get_state(state_name);
+				sp = cnd->find_object_state(p, qdCondition::OBJECT_STATE_NAME);
 			}
 
 			if (!sp || !p->is_state_active(sp)) return false;
@@ -1501,7 +1552,7 @@ bool qdGameDispatcher::check_condition(qdCondition *cnd) {
 				if (cnd->owner())
 					obj = dynamic_cast<const qdGameObject * >(cnd->owner()->owner());
 			} else
-				obj = get_object(object_name);
+				obj = cnd->find_game_object(qdCondition::OBJECT_NAME);
 
 			if (!obj) return false;
 		}
@@ -2165,6 +2216,8 @@ qdVideo *qdGameDispatcher::get_video(const char *name) {
 }
 
 bool qdGameDispatcher::select_scene(qdGameScene *sp, bool resources_flag) {
+	QD_TRACE_SCOPE_DETAIL("select_scene", sp ? sp->name() : NULL);
+
 	int tm = g_system->getMillis();
 
 	toggle_full_redraw();
@@ -2197,6 +2250,10 @@ bool qdGameDispatcher::select_scene(qdGameScene *sp, bool resources_flag) {
 	_cur_scene = sp;
 	qdCamera::set_current_camera(NULL);
 
+	// Объекты в условиях и ссылках по имени ищутся в активной сцене.
+	qdCondition::invalidate_all();
+	qdNamedObjectReference::objects_changed();
+
 	toggle_inventory(true);
 
 	debug("select_scene('%s', %d)", sp ? (const char *)transCyrillic(sp->name()) : "<no name>", resources_flag);
@@ -2229,6 +2286,9 @@ bool qdGameDispatcher::select_scene(qdGameScene *sp, bool resources_flag) {
 	if (_cur_scene)
 		debugC(1, kDebugLoad, "Scene loading \"%s\" %d ms", transCyrillic(_cur_scene->name()), tm);
 
+	if (resources_flag)
+		check_memory_budget();
+
 	return true;
 }
 
@@ -2529,6 +2589,10 @@ bool qdGameDispatcher::load_save(Common::SeekableReadStream *fh) {
 
 	debugC(2, kDebugSave, "qdGameDispatcher::load_save(): TOTAL SIZE %ld", fh->pos());
 
+	qdCondition::invalidate_all();
+	qdNamedObjectReference::objects_changed();
+	counters_changed();
+
 	if (cur_scene_ptr)
 		select_scene(cur_scene_ptr, false);
 
@@ -2724,6 +2788,8 @@ bool qdGameDispatcher::toggle_main_menu(bool state, const char *screen_name) {
 			_interface_dispatcher.select_screen(screen_name);
 			_interface_dispatcher.activate();
 			pause();
+
+			check_memory_budget();
 			return true;
 		}
 	} else {
@@ -2797,6 +2863,8 @@ bool qdGameDispatcher::init() {
 	for (qdCounterList::const_iterator it = counter_list().begin(); it != counter_list().end(); ++it)
 		(*it)->init();
 
+	counters_changed();
+
 	for (qdGameObjectList::const_iterator it = global_object_list().begin(); it != global_object_list().end(); ++it)
 		(*it)->init();
 
@@ -2920,6 +2988,7 @@ bool qdGameDispatcher::is_scene_in_list(const qdGameScene *p) {
 bool qdGameDispatcher::add_counter(qdCounter *p) {
 	if (_counters.add_object(p)) {
 		p->set_owner(this);
+		counters_changed();
 		return true;
 	}
 
@@ -2931,7 +3000,12 @@ bool qdGameDispatcher::rename_counter(qdCounter *p, const char *name) {
 }
 
 bool qdGameDispatcher::remove_counter(qdCounter *p) {
-	return _counters.remove_object(p);
+	if (_counters.remove_object(p)) {
+		counters_changed();
+		return true;
+	}
+
+	return false;
 }
 
 qdCounter *qdGameDispatcher::get_counter(const char *name) {
@@ -2946,6 +3020,44 @@ bool qdGameDispatcher::is_counter_in_list(qdCounter *p) {
 	return _counters.is_in_list(p);
 }
 
+void qdGameDispatcher::state_activation_changed(const qdGameObjectState *prev_state, const qdGameObjectState *state) {
+	// Без индекса все счетчики и так будут полностью проверены в quant().
+	if (!_counter_index_valid)
+		return;
+
+	const qdGameObjectState *states[2] = { prev_state, state };
+	for (int i = 0; i < 2; i++) {
+		if (!states[i])
+			continue;
+
+		counter_index_t::const_iterator it = _counter_index.find(states[i]);
+		if (it == _counter_index.end())
+			continue;
+
+		for (uint j = 0; j < it->_value.size(); j++)
+			it->_value[j]->state_activation_changed(states[i]);
+	}
+}
+
+void qdGameDispatcher::build_counter_index() {
+	_counter_index.clear();
+
+	for (qdCounterList::const_iterator it = counter_list().begin(); it != counter_list().end(); ++it) {
+		for (auto &el : (*it)->elements()) {
+			if (!el.state())
+				continue;
+
+			Std::vector<qdCounter *> &counters = _counter_index[el.state()];
+			if (counters.empty() || counters.back() != *it)
+				counters.push_back(*it);
+		}
+
+		(*it)->check_all_elements();
+	}
+
+	_counter_index_valid = true;
+}
+
 static Common::String change_ext(const char *file_name, const char *new_ext) {
 	Common::String fpath(file_name);
 	Common::replace(fpath, ".tga", new_ext);
@@ -3069,6 +3181,10 @@ bool qdGameDispatcher::add_dialog_state(qdGameObjectState *p) {
 }
 
 bool qdGameDispatcher::activate_trigger_links(const qdNamedObject *p) {
+	// На объект не ссылается ни один элемент триггеров
+	if (p && !p->is_in_triggers())
+		return true;
+
 	for (qdTriggerChainList::const_iterator it = trigger_chain_list().begin(); it != trigger_chain_list().end(); ++it)
 		(*it)->activate_links(p);
 
@@ -3168,6 +3284,64 @@ bool qdGameDispatcher::write_resource_stats(const char *file_name) const {
 	return true;
 }
 
+// Владелец ресурса - состояние объекта, относится к сцене, если она есть среди его владельцев.
+struct qdSceneResourceOwnerFilter {
+	qdSceneResourceOwnerFilter(const qdGameScene *scene) : _scene(scene) { }
+
+	bool operator()(const qdNamedObject *owner) const {
+		const qdNamedObject *scene = owner ? owner->owner(QD_NAMED_OBJECT_SCENE) : NULL;
+		return scene == _scene;
+	}
+
+	const qdGameScene *_scene;
+};
+
+void qdGameDispatcher::memory_stats(qdResourceMemoryStats &stats) const {
+	qdGameDispatcherBase::memory_stats(stats);
+
+	stats.add_resource(_mouse_animation);
+
+	for (auto &it : fonts_list()) {
+		if (it->font())
+			stats.add_data(qdResourceMemoryStats::MEM_FONT, it->font()->data_size());
+	}
+
+	registered_resources_memory_stats(stats, NULL);
+}
+
+void qdGameDispatcher::registered_resources_memory_stats(qdResourceMemoryStats &stats, const qdGameScene *scene) const {
+	memory_stats_if(stats, qdSceneResourceOwnerFilter(scene));
+}
+
+void qdGameDispatcher::total_memory_stats(qdResourceMemoryStats &stats) const {
+	memory_stats(stats);
+
+	for (auto &it : scene_list())
+		it->memory_stats(stats);
+
+	_interface_dispatcher.memory_stats(stats);
+}
+
+bool qdGameDispatcher::check_memory_budget() {
+	if (!g_engine->_memoryBudget)
+		return true;
+
+	qdResourceMemoryStats stats;
+	total_memory_stats(stats);
+
+	uint32 size = stats.total_size() / 1024;
+	if (size > g_engine->_memoryBudget) {
+		if (!_memory_budget_exceeded) {
+			warning("Resource memory budget exceeded: %u KB of %u KB (%s)", size, g_engine->_memoryBudget, stats.to_string().c_str());
+			_memory_budget_exceeded = true;
+		}
+		return false;
+	}
+
+	_memory_budget_exceeded = false;
+	return true;
+}
+
 bool qdGameDispatcher::update_ingame_interface() {
 	if (_cur_scene && _cur_scene->has_interface_screen()) {
 		debugC(3, kDebugQuant, "qdGameDispatcher::update_ingame_interface() update_ingame_interface");
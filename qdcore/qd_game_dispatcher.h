@@ -23,6 +23,9 @@
 #ifndef QDENGINE_QDCORE_QD_GAME_DISPATCHER_H
 #define QDENGINE_QDCORE_QD_GAME_DISPATCHER_H
 
+#include "common/hashmap.h"
+#include "common/hash-ptr.h"
+
 #include "qdengine/parser/xml_fwd.h"
 #include "qdengine/system/input/mouse_input.h"
 #include "qdengine/system/graphics/gr_screen_region.h"
@@ -120,12 +123,23 @@ public:
 		return _timer;
 	}
 
+	//! Количество логических квантов, сделанных с начала работы.
+	uint32 quant_index() const {
+		return _quant_index;
+	}
+
 	bool start_intro_videos();
 
 	void quant();
 	void quant(float dt);
 	void pre_redraw();
-	void redraw();
+	//! Перерисовка изменившихся областей экрана.
+	/**
+	Ничего не делает, если с прошлой перерисовки не было кванта,
+	мышь не двигалась и не требуется полная перерисовка экрана.
+	Возвращает true, если изображение на экране изменилось.
+	*/
+	bool redraw();
 	void post_redraw();
 
 	void update_time();
@@ -147,6 +161,20 @@ public:
 	bool is_counter_in_list(const char *name);
 	bool is_counter_in_list(qdCounter *p);
 
+	//! Уведомление счетчиков о смене текущего состояния объекта.
+	/**
+	prev_state - бывшее текущее состояние, state - новое, любое из них может быть NULL.
+	Счетчики, в которые входят эти состояния, проверят их в следующем кванте.
+	*/
+	void state_activation_changed(const qdGameObjectState *prev_state, const qdGameObjectState *state);
+	//! Все счетчики проверят все свои состояния в следующем кванте.
+	/**
+	Вызывается при изменении списков состояний объектов или элементов счетчиков.
+	*/
+	void counters_changed() {
+		_counter_index_valid = false;
+	}
+
 	bool add_minigame(qdMiniGame *p);
 	bool rename_minigame(qdMiniGame *p, const char *name);
 	bool remove_minigame(const char *name);
@@ -393,6 +421,11 @@ public:
 	qdAnimationSet *get_animation_set(const char *name);
 	qdGameObject *get_object(const char *name);
 	qdGameObjectMoving *get_active_personage();
+	//! Поиск объекта по ссылке.
+	/**
+	Найденный объект запоминается в ссылке и используется,
+	пока не изменятся списки объектов (см. qdNamedObjectReference::objects_changed()).
+	*/
 	qdNamedObject *get_named_object(const qdNamedObjectReference *ref);
 
 	qdScaleInfo *get_scale_info(const char *p);
@@ -536,6 +569,24 @@ public:
 
 	bool write_resource_stats(const char *file_name) const;
 
+	//! Учитывает в stats память глобальных ресурсов.
+	/**
+	Звуки и анимации игры, курсор мыши, шрифты и ресурсы, зарегистрированные
+	не для объектов сцен.
+	*/
+	void memory_stats(qdResourceMemoryStats &stats) const;
+	//! Учитывает в stats ресурсы, зарегистрированные для объектов сцены scene (если NULL - не принадлежащих сценам).
+	void registered_resources_memory_stats(qdResourceMemoryStats &stats, const qdGameScene *scene) const;
+	//! Учитывает в stats память всех загруженных ресурсов - глобальных, сцен и интерфейса.
+	void total_memory_stats(qdResourceMemoryStats &stats) const;
+
+	//! Проверка мягкого лимита памяти под ресурсы, см. QDEngineEngine::_memoryBudget.
+	/**
+	При превышении лимита выводит предупреждение, один раз до того, как
+	объем ресурсов снова опустится ниже лимита. Возвращает true, если лимит не превышен.
+	*/
+	bool check_memory_budget();
+
 	int hall_of_fame_size() const {
 		return _hall_of_fame_size;
 	}
@@ -597,6 +648,15 @@ private:
 	qdObjectListContainer<qdGameScene> _scenes;
 	qdObjectListContainer<qdCounter> _counters;
 
+	typedef Common::HashMap<const qdGameObjectState *, Std::vector<qdCounter *> > counter_index_t;
+	//! Счетчики по состояниям, которые в них входят.
+	counter_index_t _counter_index;
+	//! false, если индекс счетчиков надо построить заново.
+	bool _counter_index_valid;
+
+	//! Построение _counter_index, все счетчики отмечаются для полной проверки.
+	void build_counter_index();
+
 	qdGameScene *_cur_scene;
 	bool _scene_saved;
 	int _autosave_slot;
@@ -620,6 +680,17 @@ private:
 	qdAnimation *_mouse_animation;
 	Vect2f _mouse_cursor_pos;
 
+	//! Количество сделанных логических квантов, см. quant_index().
+	uint32 _quant_index;
+
+	//! true, если с последней перерисовки был квант.
+	bool _quant_since_redraw;
+	//! Положение мыши при последней перерисовке.
+	Vect2i _redraw_mouse_pos;
+
+	//! true, если о превышении лимита памяти уже предупредили.
+	bool _memory_budget_exceeded;
+
 	typedef Std::vector<qdGameObjectState *> dialog_states_container_t;
 	dialog_states_container_t _dialog_states;
 	dialog_states_container_t _dialog_states_last;
@@ -671,6 +742,9 @@ private:
 
 	/// вытаскивает из интерфейса имена игроков в таблице рекордов
 	bool update_hall_of_fame_names();
+
+	//! Поиск объекта по ссылке, без учета запомненного в ней результата.
+	qdNamedObject *find_named_object(const qdNamedObjectReference *ref);
 };
 
 qdGameDispatcher *qd_get_game_dispatcher();
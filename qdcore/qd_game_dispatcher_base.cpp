@@ -154,6 +154,14 @@ int qdGameDispatcherBase::get_resources_size() {
 	return 0;
 }
 
+void qdGameDispatcherBase::memory_stats(qdResourceMemoryStats &stats) const {
+	for (auto &is : sound_list())
+		stats.add_resource(is);
+
+	for (auto &ia : animation_list())
+		stats.add_resource(ia);
+}
+
 void qdGameDispatcherBase::show_loading_progress(int sz) {
 	_loading_progress.show_progress(sz);
 }
@@ -29,9 +29,7 @@
 #include "qdengine/qd_fwd.h"
 #include "qdengine/parser/xml_fwd.h"
 
-#ifdef __QD_DEBUG_ENABLE__
 #include "qdengine/qdcore/qd_resource.h"
-#endif
 
 namespace QDEngine {
 
@@ -141,6 +139,9 @@ public:
 
 	virtual int get_resources_size();
 
+	//! Учитывает в stats память, занятую загруженными звуками и анимациями.
+	virtual void memory_stats(qdResourceMemoryStats &stats) const;
+
 	qdConditionalObject::trigger_start_mode trigger_start() {
 		return qdConditionalObject::TRIGGER_START_FAILED;
 	}
@@ -28,6 +28,7 @@
 #include "qdengine/parser/qdscr_parser.h"
 #include "qdengine/qdcore/qd_game_object.h"
 #include "qdengine/qdcore/qd_camera.h"
+#include "qdengine/qdcore/qd_condition.h"
 
 
 namespace QDEngine {
@@ -35,14 +36,18 @@ namespace QDEngine {
 qdGameObject::qdGameObject() : _r(0, 0, 0),
 	_parallax_offset(0.0f, 0.0f),
 	_screen_r(0, 0),
-	_screen_depth(0.0f) {
+	_screen_depth(0.0f),
+	_in_visible_list(false),
+	_visible_list_order(0) {
 }
 
 qdGameObject::qdGameObject(const qdGameObject &obj) : qdNamedObject(obj),
 	_r(obj._r),
 	_parallax_offset(obj._parallax_offset),
 	_screen_r(obj._screen_r),
-	_screen_depth(obj._screen_depth) {
+	_screen_depth(obj._screen_depth),
+	_in_visible_list(false),
+	_visible_list_order(0) {
 }
 
 qdGameObject::~qdGameObject() {
@@ -182,6 +187,7 @@ bool qdGameObject::init() {
 	drop_flag(QD_OBJ_SCREEN_COORDS_FLAG);
 	drop_flag(QD_OBJ_STATE_CHANGE_FLAG | QD_OBJ_IS_IN_TRIGGER_FLAG | QD_OBJ_STATE_CHANGE_FLAG | QD_OBJ_IS_IN_INVENTORY_FLAG);
 	drop_flag(QD_OBJ_HIDDEN_FLAG);
+	qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
 	return true;
 }
 
@@ -100,6 +100,21 @@ public:
 		return !check_flag(QD_OBJ_HIDDEN_FLAG);
 	}
 
+	//! true, если объект находится в списке отрисовываемых объектов сцены.
+	bool is_in_visible_list() const {
+		return _in_visible_list;
+	}
+	void set_in_visible_list(bool state) {
+		_in_visible_list = state;
+	}
+	//! Номер объекта в списке объектов сцены, упорядочивает объекты одинаковой глубины.
+	int visible_list_order() const {
+		return _visible_list_order;
+	}
+	void set_visible_list_order(int order) {
+		_visible_list_order = order;
+	}
+
 	const Vect3f &R() const {
 		return _r;
 	}
@@ -132,6 +147,10 @@ public:
 	virtual bool restore_grid_zone() {
 		return false;
 	}
+	//! Обновляет отпечаток объекта на сетке, present - должен ли объект занимать сетку.
+	virtual bool update_grid_zone(bool present) {
+		return false;
+	}
 	virtual bool set_grid_zone_attributes(int attr) const {
 		return false;
 	}
@@ -169,6 +188,9 @@ private:
 
 	Vect2i _screen_r;
 	float _screen_depth;
+
+	bool _in_visible_list;
+	int _visible_list_order;
 };
 
 #ifdef __QD_DEBUG_ENABLE__
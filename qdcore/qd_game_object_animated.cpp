@@ -36,12 +36,24 @@
 
 namespace QDEngine {
 
+//! Номера состояний объекта сдвинулись - счетчики проверят все свои состояния.
+static void states_changed() {
+	if (qdGameDispatcher *dp = qdGameDispatcher::get_dispatcher())
+		dp->counters_changed();
+}
+
 qdGameObjectAnimated::qdGameObjectAnimated() : _cur_state(-1),
 	_inventory_type(0),
 	_last_state(NULL),
 	_default_r(0, 0, 0),
 	_grid_r(0, 0, 0),
 	_grid_size(0, 0),
+	_grid_zone_camera(NULL),
+	_grid_zone_epoch(0),
+	_grid_zone_pos(0, 0),
+	_grid_zone_size(0, 0),
+	_grid_zone_attr(0),
+	_state_index_valid(false),
 	_queued_state(NULL),
 	_last_frame(NULL),
 	_inventory_cell_index(-1),
@@ -71,6 +83,12 @@ qdGameObjectAnimated::qdGameObjectAnimated(const qdGameObjectAnimated &obj) : qd
 	_default_r(obj._default_r),
 	_grid_r(0, 0, 0),
 	_grid_size(0, 0),
+	_grid_zone_camera(NULL),
+	_grid_zone_epoch(0),
+	_grid_zone_pos(0, 0),
+	_grid_zone_size(0, 0),
+	_grid_zone_attr(0),
+	_state_index_valid(false),
 	_inventory_name(obj._inventory_name),
 	_last_state(NULL),
 	_inventory_cell_index(-1),
@@ -146,6 +164,9 @@ qdGameObjectAnimated &qdGameObjectAnimated::operator = (const qdGameObjectAnimat
 }
 
 void qdGameObjectAnimated::clear_states() {
+	_state_index_valid = false;
+	states_changed();
+
 	for (auto &it : _states) {
 		it->dec_reference_count();
 
@@ -381,6 +402,9 @@ bool qdGameObjectAnimated::insert_state(int iBefore, qdGameObjectState *p) {
 	p->inc_reference_count();
 
 	_states.insert(_states.begin() + iBefore, p);
+	_state_index_valid = false;
+	qdNamedObjectReference::objects_changed();
+	states_changed();
 
 	if (!p->name()) {
 		Common::String nameStr;
@@ -395,6 +419,9 @@ bool qdGameObjectAnimated::add_state(qdGameObjectState *p) {
 	p->inc_reference_count();
 
 	_states.push_back(p);
+	_state_index_valid = false;
+	qdNamedObjectReference::objects_changed();
+	states_changed();
 
 	if (!p->name()) {
 		Common::String nameStr;
@@ -412,6 +439,9 @@ qdGameObjectState *qdGameObjectAnimated::remove_state(int state_num) {
 
 	qdGameObjectState *p = *it;
 	_states.erase(it);
+	_state_index_valid = false;
+	qdNamedObjectReference::objects_changed();
+	states_changed();
 
 	p->dec_reference_count();
 
@@ -425,6 +455,9 @@ bool qdGameObjectAnimated::remove_state(qdGameObjectState *p) {
 	qdGameObjectStateVector::iterator it = Common::find(_states.begin(), _states.end(), p);
 	if (it != _states.end()) {
 		_states.erase(it);
+		_state_index_valid = false;
+		qdNamedObjectReference::objects_changed();
+		states_changed();
 		p->dec_reference_count();
 
 		if (_cur_state >= max_state())
@@ -559,6 +592,7 @@ void qdGameObjectAnimated::set_state(int st) {
 		}
 
 		p->set_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_WAS_ACTIVATED);
+		qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
 
 		if (p->is_in_triggers())
 			set_flag(QD_OBJ_IS_IN_TRIGGER_FLAG);
@@ -602,6 +636,7 @@ void qdGameObjectAnimated::set_state(int st) {
 
 		p->drop_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_MOVE_TO_INVENTORY_FAILED);
 		drop_flag(QD_OBJ_HIDDEN_FLAG);
+		qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
 
 		p->drop_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_ACTIVATION_TIMER);
 		p->drop_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_ACTIVATION_TIMER_END);
@@ -855,21 +890,17 @@ bool qdGameObjectAnimated::hit(int x, int y) const {
 }
 
 qdGameObjectState *qdGameObjectAnimated::get_state(const char *state_name) {
-	for (auto &it : _states) {
-		if (it-> name() && !strcmp(it->name(), state_name)) {
-			return it;
-		}
-	}
+	int idx = get_state_index(state_name);
+	if (idx != -1)
+		return _states[idx];
 
 	return NULL;
 }
 
 const qdGameObjectState *qdGameObjectAnimated::get_state(const char *state_name) const {
-	for (auto &it : _states) {
-		const qdGameObjectState *p = it;
-		if (it->name() && !strcmp(it->name(), state_name))
-			return p;
-	}
+	int idx = get_state_index(state_name);
+	if (idx != -1)
+		return _states[idx];
 
 	return NULL;
 }
@@ -975,6 +1006,8 @@ void qdGameObjectAnimated::merge_states(qdGameObjectAnimated *p) {
 			insert_state(i, p->_states[i]);
 			p->_states[i]->set_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_GLOBAL_OWNER);
 		}
+		// Состояния, найденные в условиях по имени, могли поменяться.
+		qdCondition::invalidate_all();
 	}
 }
 
@@ -990,6 +1023,7 @@ void qdGameObjectAnimated::split_states(qdGameObjectAnimated *p) {
 	}
 
 	_cur_state = st;
+	qdCondition::invalidate_all();
 }
 
 bool qdGameObjectAnimated::init_grid_zone() {
@@ -1006,20 +1040,64 @@ bool qdGameObjectAnimated::init_grid_zone() {
 	return false;
 }
 
-bool qdGameObjectAnimated::toggle_grid_zone(bool make_walkable) {
-	if (make_walkable)
-		return drop_grid_zone_attributes(sGridCell::CELL_OCCUPIED);
-	else
-		return set_grid_zone_attributes(sGridCell::CELL_OCCUPIED);
-}
-
 bool qdGameObjectAnimated::save_grid_zone() {
 	_grid_r = R();
 	return true;
 }
 
 bool qdGameObjectAnimated::restore_grid_zone() {
-	return toggle_grid_zone(true);
+	// Отпечаток снимается через счетчики, чтобы они оставались верными.
+	return update_grid_zone(false);
+}
+
+int qdGameObjectAnimated::grid_zone_attribute() const {
+	return sGridCell::CELL_OCCUPIED;
+}
+
+bool qdGameObjectAnimated::update_grid_zone(bool present) {
+	qdCamera *cp = NULL;
+	Vect2s pos(0, 0);
+	Vect2s size(0, 0);
+
+	if (present && has_bound() && owner() && owner()->named_object_type() == QD_NAMED_OBJECT_SCENE) {
+		cp = static_cast<qdGameScene *>(owner())->get_camera();
+		pos = cp->get_cell_index(_grid_r.x, _grid_r.y);
+		size = _grid_size;
+
+		if (pos.x == -1) {
+			cp = NULL;
+			pos = size = Vect2s(0, 0);
+		}
+	}
+
+	int attr = grid_zone_attribute();
+
+	// После сброса отпечатков на сетке старого отпечатка уже нет.
+	if (_grid_zone_camera && _grid_zone_epoch != _grid_zone_camera->footprint_epoch())
+		_grid_zone_camera = NULL;
+
+	if (_grid_zone_camera && (_grid_zone_camera != cp || _grid_zone_attr != attr)) {
+		_grid_zone_camera->move_grid_footprint(_grid_zone_pos, _grid_zone_size, Vect2s(0, 0), Vect2s(0, 0), _grid_zone_attr);
+		_grid_zone_camera = NULL;
+	}
+
+	if (cp) {
+		if (_grid_zone_camera)
+			cp->move_grid_footprint(_grid_zone_pos, _grid_zone_size, pos, size, attr);
+		else
+			cp->move_grid_footprint(Vect2s(0, 0), Vect2s(0, 0), pos, size, attr);
+
+		_grid_zone_epoch = cp->footprint_epoch();
+	} else if (_grid_zone_camera) {
+		_grid_zone_camera->move_grid_footprint(_grid_zone_pos, _grid_zone_size, Vect2s(0, 0), Vect2s(0, 0), attr);
+	}
+
+	_grid_zone_camera = cp;
+	_grid_zone_pos = pos;
+	_grid_zone_size = size;
+	_grid_zone_attr = attr;
+
+	return cp != NULL;
 }
 
 qdGameObjectState *qdGameObjectAnimated::get_inventory_state() {
@@ -1160,6 +1238,7 @@ bool qdGameObjectAnimated::handle_state_end() {
 		sp->stop_sound();
 		_animation.clear();
 		set_flag(QD_OBJ_HIDDEN_FLAG);
+		qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
 	}
 
 	if (sp->check_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_MOVE_TO_INVENTORY) && !sp->check_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_MOVE_TO_INVENTORY_FAILED)) {
@@ -1238,6 +1317,18 @@ const qdGameObjectState *qdGameObjectAnimated::get_default_state() const {
 	return NULL;
 }
 
+void qdGameObjectAnimated::set_cur_state(int st) {
+	if (st != _cur_state) {
+		if (qdGameDispatcher *dp = qdGameDispatcher::get_dispatcher()) {
+			const qdGameObjectState *state = (st >= 0 && st < max_state()) ? _states[st] : NULL;
+			dp->state_activation_changed(get_cur_state(), state);
+		}
+	}
+
+	_cur_state = st;
+	qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
+}
+
 int qdGameObjectAnimated::get_state_index(const qdGameObjectState *p) const {
 	for (int i = 0; i < _states.size(); i++) {
 		if (_states[i] == p)
@@ -1247,6 +1338,32 @@ int qdGameObjectAnimated::get_state_index(const qdGameObjectState *p) const {
 	return -1;
 }
 
+int qdGameObjectAnimated::get_state_index(const char *state_name) const {
+	if (!state_name)
+		return -1;
+
+	if (!_state_index_valid)
+		build_state_index();
+
+	state_index_t::const_iterator it = _state_index.find(state_name);
+	if (it != _state_index.end())
+		return it->_value;
+
+	return -1;
+}
+
+void qdGameObjectAnimated::build_state_index() const {
+	_state_index.clear();
+
+	// При совпадении имен находится первое состояние, как и при переборе списка.
+	for (int i = 0; i < _states.size(); i++) {
+		if (_states[i]->name() && !_state_index.contains(_states[i]->name()))
+			_state_index[_states[i]->name()] = i;
+	}
+
+	_state_index_valid = true;
+}
+
 bool qdGameObjectAnimated::load_data(Common::SeekableReadStream &fh, int save_version) {
 	debugC(4, kDebugSave, "    qdGameObjectAnimated::load_data before: %ld", fh.pos());
 	if (!qdGameObject::load_data(fh, save_version)) return false;
@@ -1346,10 +1463,9 @@ bool qdGameObjectAnimated::is_state_waiting(const char *state_name) const {
 }
 
 bool qdGameObjectAnimated::was_state_active(const char *state_name) const {
-	for (int i = 0; i < _states.size(); i++) {
-		if (!strcmp(_states[i]->name(), state_name))
-			return _states[i]->check_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_WAS_ACTIVATED);
-	}
+	int idx = get_state_index(state_name);
+	if (idx != -1)
+		return _states[idx]->check_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_WAS_ACTIVATED);
 
 	return false;
 }
@@ -1475,6 +1591,8 @@ bool qdGameObjectAnimated::init() {
 	for (int i = 0; i < _states.size(); i++)
 		_states[i]->init();
 
+	qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
+
 	return true;
 }
 
@@ -1535,6 +1653,9 @@ void qdGameObjectAnimated::post_redraw() {
 void qdGameObjectAnimated::set_states_owner() {
 	for (int i = 0; i < max_state(); i++)
 		_states[i]->set_owner(this);
+
+	// Условия состояний без явно указанного объекта ссылаются на владельца.
+	qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
 }
 
 qdGameObjectState *qdGameObjectAnimated::get_mouse_state() {
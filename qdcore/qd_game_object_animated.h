@@ -22,6 +22,9 @@
 #ifndef QDENGINE_QDCORE_QD_GAME_OBJECT_ANIMATED_H
 #define QDENGINE_QDCORE_QD_GAME_OBJECT_ANIMATED_H
 
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+
 #include "qdengine/parser/xml_fwd.h"
 #include "qdengine/qdcore/qd_animation.h"
 #include "qdengine/qdcore/qd_coords_animation.h"
@@ -79,15 +82,15 @@ public:
 		return _cur_state;
 	}
 	//! Устанавливает номер текущего состояния объекта.
-	void set_cur_state(int st) {
-		_cur_state = st;
-	}
+	void set_cur_state(int st);
 	//! Возвращает количество состояний объекта.
 	int max_state() const {
 		return _states.size();
 	}
 	//! Возвращает номер состояния или -1 если не может такое состояние найти.
 	int get_state_index(const qdGameObjectState *p) const;
+	//! Возвращает номер состояния с именем state_name или -1 если такого состояния нет.
+	int get_state_index(const char *state_name) const;
 
 	//! Установка владельца состояний.
 	void set_states_owner();
@@ -146,6 +149,7 @@ public:
 
 	void set_queued_state(qdGameObjectState *st) {
 		_queued_state = st;
+		qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
 	}
 
 	qdGameObjectState *queued_state() {
@@ -267,9 +271,13 @@ public:
 	}
 
 	bool init_grid_zone();
-	virtual bool toggle_grid_zone(bool make_walkable = false);
 	bool save_grid_zone();
 	bool restore_grid_zone();
+	//! Переносит отпечаток объекта на сетке в точку, запомненную save_grid_zone().
+	/**
+	Меняются только клетки, не входящие одновременно в старый и новый отпечатки.
+	*/
+	bool update_grid_zone(bool present);
 	bool set_grid_zone_attributes(int attr) const;
 	bool check_grid_zone_attributes(int attr) const;
 	bool drop_grid_zone_attributes(int attr) const;
@@ -326,8 +334,10 @@ protected:
 	bool save_script_body(Common::WriteStream &fh, int indent = 0) const;
 
 	void set_last_state(qdGameObjectState *p) {
-		if (!p || !p->check_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_MOUSE_STATE | qdGameObjectState::QD_OBJ_STATE_FLAG_MOUSE_HOVER_STATE))
+		if (!p || !p->check_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_MOUSE_STATE | qdGameObjectState::QD_OBJ_STATE_FLAG_MOUSE_HOVER_STATE)) {
 			_last_state = p;
+			qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
+		}
 	}
 
 	void set_last_inventory_state(qdGameObjectState *p) {
@@ -340,6 +350,13 @@ private:
 	int _cur_state;
 	qdGameObjectStateVector _states;
 
+	typedef Common::HashMap<Common::String, int> state_index_t;
+	//! Номера состояний по именам, строится при первом поиске после изменения списка состояний.
+	mutable state_index_t _state_index;
+	mutable bool _state_index_valid;
+
+	void build_state_index() const;
+
 	qdGameObjectState *_queued_state;
 	qdGameObjectState *_last_inventory_state;
 
@@ -355,6 +372,16 @@ private:
 	Vect3f _grid_r;
 	Vect2s _grid_size;
 
+	//! Отпечаток на сетке, поставленный update_grid_zone().
+	qdCamera *_grid_zone_camera;
+	uint32 _grid_zone_epoch;
+	Vect2s _grid_zone_pos;
+	Vect2s _grid_zone_size;
+	int _grid_zone_attr;
+
+	//! Атрибут клеток, которым объект отмечает занятую им область сетки.
+	virtual int grid_zone_attribute() const;
+
 	Common::String _inventory_name;
 
 	qdScreenTransform _current_transform;
@@ -39,6 +39,8 @@
 #include "qdengine/qdcore/qd_interface_button.h"
 
 #include "qdengine/qdcore/util/AIAStar_API.h"
+#include "qdengine/qdcore/util/profiler.h"
+#include "qdengine/qdcore/util/trace_recorder.h"
 
 
 namespace QDEngine {
@@ -74,7 +76,8 @@ qdGameObjectMoving::qdGameObjectMoving() :
 	_impulse_start_timer(0.0f),
 	_impulse_direction(-1.0f),
 	_control_types(CONTROL_MOUSE),
-	_button(NULL) {
+	_button(NULL),
+	_path_cache_next(0) {
 	_ignore_personages = false;
 	_is_selected = false;
 	set_flag(QD_OBJ_HAS_BOUND_FLAG);
@@ -108,7 +111,8 @@ qdGameObjectMoving::qdGameObjectMoving(const qdGameObjectMoving &obj) : qdGameOb
 	_impulse_start_timer(0.0f),
 	_impulse_direction(-1.0f),
 	_control_types(obj._control_types),
-	_button(NULL) {
+	_button(NULL),
+	_path_cache_next(0) {
 	_ignore_personages = false;
 	_is_selected = false;
 	set_flag(QD_OBJ_HAS_BOUND_FLAG);
@@ -302,6 +306,10 @@ bool qdGameObjectMoving::save_script(Common::WriteStream &fh, int indent) const
 bool qdGameObjectMoving::move(const Vect3f &target, bool lock_target) {
 	debugC(3, kDebugMovement, "qdGameObjectMoving::move([%f, %f, %f], %d)", target.x, target.y, target.z, lock_target);
 
+	// Новый приказ отменяет отложенный поиск пути
+	if (owner() && owner()->named_object_type() == QD_NAMED_OBJECT_SCENE)
+		static_cast<qdGameScene *>(owner())->cancel_path_request(this);
+
 	set_last_move_order(target);
 	if (false == enough_far_target(target))
 		return true;
@@ -362,6 +370,8 @@ void dump_vect(const V &vect) {
 
 bool qdGameObjectMoving::find_path(const Vect3f target, bool lock_target) {
 	debugC(3, kDebugMovement, "qdGameObjectMoving::find_path([%f, %f, %f], %d)", target.x, target.y, target.z, lock_target);
+	QD_PROFILE_SCOPE(PROFILE_PATHFINDING);
+	QD_TRACE_SCOPE_DETAIL("find_path", name());
 	Vect3f trg = target;
 
 	if (!adjust_position(trg))
@@ -377,13 +387,19 @@ bool qdGameObjectMoving::find_path(const Vect3f target, bool lock_target) {
 		if (lock_target || check_grid_zone_attributes(sGridCell::CELL_IMPASSABLE)) return false;
 
 		Vect2s pt;
+		Vect2s trg_cell = qdCamera::current_camera()->get_cell_index(trg.x, trg.y, false);
 		if (allowed_directions_count() <= 2)
-			pt = get_nearest_walkable_point(qdCamera::current_camera()->get_cell_index(trg.x, trg.y, false));
-		else
-			// Для движения с двумя степенями свободы смотрим последюнюю доступную
-			// потому как в случае неудачи мы все равно проверим все подходящие нам для подхода.
-			// Но зато получим выигрышь в оптимальности нахождения максимально близкого пути.
-			pt = get_pre_last_walkable_point(qdCamera::current_camera()->get_cell_index(trg.x, trg.y, false));
+			pt = get_nearest_walkable_point(trg_cell);
+		else {
+			// Берем ближайшую к цели проходимую клетку из таблицы камеры. Если персонаж
+			// там не помещается (объекты, другие персонажи, размер), то ищем вдоль отрезка.
+			pt = qdCamera::current_camera()->get_nearest_passable_cell(trg_cell);
+			if (pt.x == -1 || pt == qdCamera::current_camera()->get_cell_index(R().x, R().y) || !is_walkable(pt))
+				// Для движения с двумя степенями свободы смотрим последюнюю доступную
+				// потому как в случае неудачи мы все равно проверим все подходящие нам для подхода.
+				// Но зато получим выигрышь в оптимальности нахождения максимально близкого пути.
+				pt = get_pre_last_walkable_point(trg_cell);
+		}
 		if (pt.x == -1) {
 			drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
 			return false;
@@ -410,6 +426,69 @@ bool qdGameObjectMoving::find_path(const Vect3f target, bool lock_target) {
 		return false;
 	}
 
+	int dirs_count = (allowed_directions_count() > 4) ? 8 : 4;
+
+	PathCacheEntry request;
+	init_path_cache_key(request, cell_idx, qdCamera::current_camera()->get_cell_index(trg.x, trg.y), dirs_count, lock_target);
+
+	const PathCacheEntry *result = find_cached_path(request);
+	if (result) {
+		debugC(3, kDebugMovement, "qdGameObjectMoving::find_path(): cached path, found: %d", result->found);
+	} else {
+		request.found = search_path(cell_idx, trg, lock_target, dirs_count, request.path, request.retargeted);
+		request.final_target = qdCamera::current_camera()->get_cell_index(trg.x, trg.y);
+		result = add_cached_path(request);
+	}
+
+	// Окончательно утверждаем путь
+	if (!result->found) {
+		drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
+		return false;
+	}
+
+	if (result->retargeted) {
+		_target_angle = calc_direction_angle(target);
+		trg = qdCamera::current_camera()->get_cell_coords(result->final_target.x, result->final_target.y);
+	}
+
+	const Std::vector<Vect2i> &path_vect = result->path;
+	int idx;
+
+	if (path_vect.size() >= 2 && (movement_type() == qdGameObjectStateWalk::MOVEMENT_FOUR_DIRS || movement_type() == qdGameObjectStateWalk::MOVEMENT_EIGHT_DIRS)) {
+		Std::vector<Vect3f> final_path;
+		finalize_path(R(), trg, path_vect, final_path);
+
+		for (int i = 0; i < final_path.size(); i++)
+			_path[i] = final_path[i];
+
+		idx = final_path.size();
+
+		debugC(3, kDebugLog, "Final Path");
+		dump_vect(final_path);
+	} else {
+		idx = 0;
+		for (Std::vector<Vect2i>::const_iterator it = path_vect.begin(); it != path_vect.end(); ++it) {
+			_path[idx] = qdCamera::current_camera()->get_cell_coords(it->x, it->y);
+			idx ++;
+		}
+		_path[idx - 1] = trg;
+	}
+
+	_cur_path_index = (idx > 1) ? 1 : 0;
+	_path_length = idx;
+	move2position(_path[_cur_path_index++]);
+
+	if (_cur_path_index >= _path_length)
+		_path_length = 0;
+
+	drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
+	return true;
+}
+
+
+bool qdGameObjectMoving::search_path(const Vect2s &start, Vect3f &trg, bool lock_target, int dirs_count, Std::vector<Vect2i> &path_vect, bool &retargeted) const {
+	retargeted = false;
+
 	qdHeuristic phobj;
 	phobj.set_camera(qdCamera::current_camera());
 	phobj.set_object(this);
@@ -418,10 +497,7 @@ bool qdGameObjectMoving::find_path(const Vect3f target, bool lock_target) {
 	qdAStar pfobj;
 	pfobj.Init(qdCamera::current_camera()->get_grid_sx(), qdCamera::current_camera()->get_grid_sy());
 
-	int dirs_count = (allowed_directions_count() > 4) ? 8 : 4;
-
-	Std::vector<Vect2i> path_vect;
-	pfobj.FindPath(cell_idx, &phobj, path_vect, dirs_count);
+	pfobj.FindPath(start, &phobj, path_vect, dirs_count);
 
 	int idx = 0;
 	bool correct = true;
@@ -439,16 +515,15 @@ bool qdGameObjectMoving::find_path(const Vect3f target, bool lock_target) {
 	while ((false == lock_target) && (false == correct)) {
 		// Пересчитываем конечную точку
 		Vect2s pt = get_pre_last_walkable_point(qdCamera::current_camera()->get_cell_index(trg.x, trg.y, false));
-		if (pt.x == -1) {
-			drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
+		if (pt.x == -1)
 			return false;
-		}
-		_target_angle = calc_direction_angle(target);
+
+		retargeted = true;
 		trg = qdCamera::current_camera()->get_cell_coords(pt.x, pt.y);
 
 		// Считаем путь с новым концом
 		phobj.init(trg);
-		pfobj.FindPath(cell_idx, &phobj, path_vect, dirs_count);
+		pfobj.FindPath(start, &phobj, path_vect, dirs_count);
 
 		// Проверяем путь на проходимость
 		correct = true;
@@ -464,11 +539,8 @@ bool qdGameObjectMoving::find_path(const Vect3f target, bool lock_target) {
 		if (0 == idx) correct = false;
 	}
 
-	// Окончательно утверждаем путь
-	if ((false == correct) || (idx > QD_MOVING_OBJ_PATH_LENGTH) || !idx) {
-		drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
+	if ((false == correct) || (idx > QD_MOVING_OBJ_PATH_LENGTH) || !idx)
 		return false;
-	}
 
 	debugC(3, kDebugLog, "The path is found");
 	dump_vect(path_vect);
@@ -478,39 +550,50 @@ bool qdGameObjectMoving::find_path(const Vect3f target, bool lock_target) {
 	debugC(3, kDebugLog, "Optimised Path");
 	dump_vect(path_vect);
 
-	if (path_vect.size() >= 2 && (movement_type() == qdGameObjectStateWalk::MOVEMENT_FOUR_DIRS || movement_type() == qdGameObjectStateWalk::MOVEMENT_EIGHT_DIRS)) {
-		Std::vector<Vect3f> final_path;
-		finalize_path(R(), trg, path_vect, final_path);
+	return true;
+}
 
-		for (int i = 0; i < final_path.size(); i++)
-			_path[i] = final_path[i];
+void qdGameObjectMoving::init_path_cache_key(PathCacheEntry &entry, const Vect2s &start, const Vect2s &target, int dirs_count, bool lock_target) const {
+	const qdCamera *cp = qdCamera::current_camera();
 
-		idx = final_path.size();
+	entry.camera = cp;
+	entry.grid_version = cp->grid_version();
+	entry.start = start;
+	entry.target = target;
+	entry.footprint = _walk_grid_size;
+	entry.dirs_count = dirs_count;
+	entry.movement_type = movement_type();
+	entry.ignore_personages = _ignore_personages;
+	entry.lock_target = lock_target;
+}
 
-		debugC(3, kDebugLog, "Final Path");
-		dump_vect(final_path);
-	} else {
-		idx = 0;
-		for (Std::vector<Vect2i>::const_iterator it = path_vect.begin(); it != path_vect.end(); ++it) {
-			_path[idx] = qdCamera::current_camera()->get_cell_coords(it->x, it->y);
-			idx ++;
-		}
-		_path[idx - 1] = trg;
+const qdGameObjectMoving::PathCacheEntry *qdGameObjectMoving::find_cached_path(const PathCacheEntry &key) const {
+	for (int i = 0; i < PATH_CACHE_SIZE; i++) {
+		const PathCacheEntry &entry = _path_cache[i];
+		if (entry.camera == key.camera && entry.grid_version == key.grid_version &&
+		        entry.start == key.start && entry.target == key.target && entry.footprint == key.footprint &&
+		        entry.dirs_count == key.dirs_count && entry.movement_type == key.movement_type &&
+		        entry.ignore_personages == key.ignore_personages && entry.lock_target == key.lock_target)
+			return &entry;
 	}
 
-	_cur_path_index = (idx > 1) ? 1 : 0;
-	_path_length = idx;
-	move2position(_path[_cur_path_index++]);
+	return NULL;
+}
 
-	if (_cur_path_index >= _path_length)
-		_path_length = 0;
+const qdGameObjectMoving::PathCacheEntry *qdGameObjectMoving::add_cached_path(const PathCacheEntry &entry) {
+	PathCacheEntry &slot = _path_cache[_path_cache_next];
+	slot = entry;
 
-	drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
-	return true;
-}
+	if (++_path_cache_next >= PATH_CACHE_SIZE)
+		_path_cache_next = 0;
 
+	return &slot;
+}
 
 bool qdGameObjectMoving::stop_movement() {
+	if (owner() && owner()->named_object_type() == QD_NAMED_OBJECT_SCENE)
+		static_cast<qdGameScene *>(owner())->cancel_path_request(this);
+
 	if (check_flag(QD_OBJ_MOVING_FLAG)) {
 		drop_flag(QD_OBJ_MOVING_FLAG);
 
@@ -992,34 +1075,45 @@ void qdGameObjectMoving::clear_path_attributes(int attr) const {
 }
 
 bool qdGameObjectMoving::is_path_walkable(int x1, int y1, int x2, int y2) const {
-	if (x1 == x2 && y1 == y2) {
-		if (!is_walkable(Vect2s(x1, y1)))
-			return false;
+	// Проходим по всем клеткам, которые задевает отрезок между центрами
+	// начальной и конечной клеток (Amanatides-Woo), каждую - один раз.
+	if (!is_walkable(Vect2s(x1, y1)))
+		return false;
 
-		return true;
-	}
+	int nx = abs(x2 - x1);
+	int ny = abs(y2 - y1);
 
-	Vect2f r(x1, y1);
+	int sx = (x2 > x1) ? 1 : -1;
+	int sy = (y2 > y1) ? 1 : -1;
 
-	Vect2f dr(x2 - x1, y2 - y1);
-	dr.normalize(0.2f);
+	int x = x1;
+	int y = y1;
 
-	if (abs(x2 - x1) > abs(y2 - y1)) {
-		int dx = round(float(x2 - x1) / dr.x);
-		do {
-			if (!is_walkable(Vect2s(r.xi(), r.yi())))
-				return false;
+	for (int ix = 0, iy = 0; ix < nx || iy < ny;) {
+		// Сравниваем, какую из границ клетки - вертикальную или горизонтальную -
+		// отрезок пересекает раньше. Все в целых, без накопления погрешности.
+		int decision = (1 + 2 * ix) * ny - (1 + 2 * iy) * nx;
 
-			r += dr;
-		} while (--dx >= 0);
-	} else {
-		int dy = round(float(y2 - y1) / dr.y);
-		do {
-			if (!is_walkable(Vect2s(r.xi(), r.yi())))
+		if (decision == 0) {
+			// Отрезок проходит точно через угол клетки - проверяем обе соседние,
+			// как и при диагональном шаге в qdHeuristic::GetG().
+			if (!is_walkable(Vect2s(x + sx, y)) || !is_walkable(Vect2s(x, y + sy)))
 				return false;
 
-			r += dr;
-		} while (--dy >= 0);
+			x += sx;
+			y += sy;
+			ix++;
+			iy++;
+		} else if (decision < 0) {
+			x += sx;
+			ix++;
+		} else {
+			y += sy;
+			iy++;
+		}
+
+		if (!is_walkable(Vect2s(x, y)))
+			return false;
 	}
 
 	return true;
@@ -1347,6 +1441,7 @@ void qdGameObjectMoving::set_state(int st) {
 		drop_flag(QD_OBJ_HIDDEN_FLAG);
 
 		p->set_flag(qdGameObjectState::QD_OBJ_STATE_FLAG_WAS_ACTIVATED);
+		qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
 
 		if (p->is_in_triggers())
 			set_flag(QD_OBJ_IS_IN_TRIGGER_FLAG);
@@ -2656,13 +2751,8 @@ bool qdGameObjectMoving::can_change_state(const qdGameObjectState *state) const
 	return true;
 }
 
-bool qdGameObjectMoving::toggle_grid_zone(bool make_walkable) {
-	debugC(4, kDebugMovement, "qdGameObjectMoving::toggle_grid_zone(%d)", make_walkable);
-
-	if (make_walkable)
-		return drop_grid_zone_attributes(sGridCell::CELL_PERSONAGE_OCCUPIED);
-	else
-		return set_grid_zone_attributes(sGridCell::CELL_PERSONAGE_OCCUPIED);
+int qdGameObjectMoving::grid_zone_attribute() const {
+	return sGridCell::CELL_PERSONAGE_OCCUPIED;
 }
 
 bool qdGameObjectMoving::move_from_personage_path() {
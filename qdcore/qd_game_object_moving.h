@@ -27,6 +27,7 @@
 
 namespace QDEngine {
 
+class qdCamera;
 class qdInterfaceButton;
 
 const int QD_MOVING_OBJ_PATH_LENGTH = 200;
@@ -342,7 +343,7 @@ public:
 	bool avoid_collision(const qdGameObjectMoving *p);
 	bool move_from_personage_path();
 
-	bool toggle_grid_zone(bool make_walkable = false);
+	int grid_zone_attribute() const;
 	void toggle_selection(bool state) {
 		_is_selected = state;
 	}
@@ -420,6 +421,58 @@ private:
 
 	mutable qdInterfaceButton *_button;
 
+	//! Результат поиска пути, сохраненный для повторных запросов.
+	/**
+	Запись действительна, пока не изменилась версия сетки камеры
+	(см. qdCamera::grid_version()) и совпадают параметры запроса.
+	Собственная выделенная зона персонажа учитывается версией сетки.
+	*/
+	struct PathCacheEntry {
+		PathCacheEntry() : camera(NULL), grid_version(0), start(-1, -1), target(-1, -1), footprint(0, 0),
+			dirs_count(0), movement_type(0), ignore_personages(false), lock_target(false),
+			found(false), retargeted(false), final_target(-1, -1) { }
+
+		const qdCamera *camera;
+		uint32 grid_version;
+
+		Vect2s start;
+		Vect2s target;
+		//! Базовый размер персонажа на сетке.
+		Vect2s footprint;
+		int dirs_count;
+		int movement_type;
+		bool ignore_personages;
+		bool lock_target;
+
+		//! true если путь найден
+		bool found;
+		//! true если конечная точка была заменена на ближайшую доступную
+		bool retargeted;
+		Vect2s final_target;
+		//! Оптимизированный путь в клетках сетки.
+		Std::vector<Vect2i> path;
+	};
+
+	enum {
+		PATH_CACHE_SIZE = 4
+	};
+
+	PathCacheEntry _path_cache[PATH_CACHE_SIZE];
+	int _path_cache_next;
+
+	//! Заполняет ключ entry по текущему состоянию объекта и сетки.
+	void init_path_cache_key(PathCacheEntry &entry, const Vect2s &start, const Vect2s &target, int dirs_count, bool lock_target) const;
+	//! Ищет в кэше запись с тем же ключом, что и key. Возвращает NULL, если не нашлось.
+	const PathCacheEntry *find_cached_path(const PathCacheEntry &key) const;
+	const PathCacheEntry *add_cached_path(const PathCacheEntry &entry);
+
+	//! Поиск пути по сетке из клетки start в точку trg.
+	/**
+	Если lock_target == false и до trg не дойти, trg заменяется на ближайшую
+	доступную точку, retargeted при этом выставляется в true.
+	*/
+	bool search_path(const Vect2s &start, Vect3f &trg, bool lock_target, int dirs_count, Std::vector<Vect2i> &path_vect, bool &retargeted) const;
+
 	Vect2s get_nearest_walkable_point(const Vect2s &target) const;
 	//! Возвращает доступную точку, предшествующую последней до target пустОте
 	Vect2s get_pre_last_walkable_point(const Vect2s &target) const;
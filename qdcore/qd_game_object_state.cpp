@@ -483,6 +483,7 @@ bool qdGameObjectState::init() {
 	drop_flag(QD_OBJ_STATE_FLAG_ACTIVATION_TIMER_END);
 	drop_flag(QD_OBJ_STATE_FLAG_MOVE_TO_INVENTORY_FAILED);
 	drop_flag(QD_OBJ_STATE_FLAG_WAS_ACTIVATED);
+	qdCondition::touch_dependencies(qdCondition::DEPENDS_ON_OBJECT_STATES);
 
 	return true;
 }
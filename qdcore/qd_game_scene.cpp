@@ -28,6 +28,8 @@
 #include "qdengine/parser/xml_tag_buffer.h"
 #include "qdengine/system/input/mouse_input.h"
 #include "qdengine/qdcore/util/plaympp_api.h"
+#include "qdengine/qdcore/util/profiler.h"
+#include "qdengine/qdcore/util/trace_recorder.h"
 #include "qdengine/parser/qdscr_parser.h"
 #include "qdengine/qdcore/qd_minigame.h"
 #include "qdengine/qdcore/qd_grid_zone.h"
@@ -56,6 +58,8 @@ grScreenRegion qdGameScene::_fps_region = grScreenRegion_EMPTY;
 grScreenRegion qdGameScene::_fps_region_last = grScreenRegion_EMPTY;
 char qdGameScene::_fps_string[255];
 Std::vector<qdGameObject *> qdGameScene::_visible_objects;
+const qdGameScene *qdGameScene::_visible_objects_scene = NULL;
+qdGameScene::HitGrid qdGameScene::_hit_grid;
 
 qdGameScene::qdGameScene() : _mouse_click_object(NULL),
 	_mouse_right_click_object(NULL),
@@ -73,6 +77,12 @@ qdGameScene::qdGameScene() : _mouse_click_object(NULL),
 
 qdGameScene::~qdGameScene() {
 	_grid_zones.clear();
+
+	if (_visible_objects_scene == this) {
+		_visible_objects.clear();
+		_visible_objects_scene = NULL;
+		invalidate_hit_grid();
+	}
 }
 
 fpsCounter *qdGameScene::fps_counter() {
@@ -83,19 +93,22 @@ fpsCounter *qdGameScene::fps_counter() {
 }
 
 void qdGameScene::init_objects_grid() {
-	_camera.drop_grid_attributes(sGridCell::CELL_OCCUPIED | sGridCell::CELL_PERSONAGE_OCCUPIED | sGridCell::CELL_SELECTED);
+	_camera.drop_grid_attributes(sGridCell::CELL_SELECTED);
 
 	for (qdGameObjectList::const_iterator io = object_list().begin(); io != object_list().end(); ++io)
 		(*io)->save_grid_zone();
 
-	for (qdGameObjectList::const_iterator io = object_list().begin(); io != object_list().end(); ++io) {
-		if ((*io)->is_visible() && !(*io)->check_flag(QD_OBJ_SCREEN_COORDS_FLAG))
-			(*io)->toggle_grid_zone();
-	}
+	// Отпечатки объектов переносятся только там, где объект сдвинулся или поменял размер.
+	for (qdGameObjectList::const_iterator io = object_list().begin(); io != object_list().end(); ++io)
+		(*io)->update_grid_zone((*io)->is_visible() && !(*io)->check_flag(QD_OBJ_SCREEN_COORDS_FLAG));
+
+	// Атрибуты клеток, восстановленные из сэйва, могут не совпадать со счетчиками.
+	_camera.sync_grid_footprints();
 }
 
 void qdGameScene::quant(float dt) {
 	debugC(9, kDebugQuant, "qdGameScene::quant(%f)", dt);
+	QD_PROFILE_SCOPE(PROFILE_SCENE_QUANT);
 
 	if (_minigame) {
 		debugC(3, kDebugQuant, "qdGameScene::quant(%f) minigame", dt);
@@ -105,14 +118,35 @@ void qdGameScene::quant(float dt) {
 	for (qdGameObjectList::const_iterator io = object_list().begin(); io != object_list().end(); ++io)
 		(*io)->update_screen_pos();
 
-	conditions_quant(dt);
-
-	personages_quant();
+	invalidate_hit_grid();
 
-	follow_quant(dt);
-	collision_quant();
+	{
+		QD_PROFILE_SCOPE(PROFILE_SCENE_PATH_REQUESTS);
+		path_requests_quant();
+	}
+	{
+		QD_PROFILE_SCOPE(PROFILE_SCENE_CONDITIONS);
+		conditions_quant(dt);
+	}
+	{
+		QD_PROFILE_SCOPE(PROFILE_SCENE_PERSONAGES);
+		personages_quant();
+	}
+	{
+		QD_PROFILE_SCOPE(PROFILE_SCENE_FOLLOW);
+		follow_quant(dt);
+	}
+	{
+		QD_PROFILE_SCOPE(PROFILE_SCENE_COLLISIONS);
+		collision_quant();
+	}
 
-	if (_camera.quant(dt)) {
+	bool camera_changed;
+	{
+		QD_PROFILE_SCOPE(PROFILE_SCENE_CAMERA);
+		camera_changed = _camera.quant(dt);
+	}
+	if (camera_changed) {
 		if (qdGameDispatcher *dp = qdGameDispatcher::get_dispatcher()) {
 			debugC(3, kDebugQuant, "qdGameScene::quant(%f) _camera", dt);
 			dp->toggle_full_redraw();
@@ -148,15 +182,20 @@ void qdGameScene::quant(float dt) {
 				    ((*it) != _selected_object) &&
 				    (*it)->has_control_type(qdGameObjectMoving::CONTROL_ACTIVE_CLICK_REACTING)
 				)
-					(*it)->move(pos, false);
+					request_path(*it, pos, false);
 		}
 	}
 
-	for (qdGameObjectList::const_iterator io = object_list().begin(); io != object_list().end(); ++io) {
-		if (!(*io)->check_flag(QD_OBJ_IS_IN_INVENTORY_FLAG))
-			(*io)->quant(dt);
+	{
+		QD_PROFILE_SCOPE(PROFILE_SCENE_OBJECTS);
+		for (qdGameObjectList::const_iterator io = object_list().begin(); io != object_list().end(); ++io) {
+			if (!(*io)->check_flag(QD_OBJ_IS_IN_INVENTORY_FLAG))
+				(*io)->quant(dt);
+		}
 	}
 
+	invalidate_hit_grid();
+
 	update_mouse_cursor();
 
 	if (_selected_object && !_selected_object->is_visible()) {
@@ -248,14 +287,8 @@ bool qdGameScene::mouse_handler(int x, int y, mouseDispatcher::mouseEvent ev) {
 				break;
 			}
 		}
-		for (Std::vector<qdGameObject *>::iterator io = _visible_objects.begin(); io != _visible_objects.end(); ++io) {
-			if (!(*io)->check_flag(QD_OBJ_DISABLE_MOUSE_FLAG) && (*io)->named_object_type() != QD_NAMED_OBJECT_STATIC_OBJ) {
-				if ((*io)->hit(x, y)) {
-					_mouse_hover_object = *io;
-					break;
-				}
-			}
-		}
+		if (qdGameObject *p = get_hitted_obj(x, y))
+			_mouse_hover_object = p;
 		break;
 	case mouseDispatcher::EV_LEFT_DOWN:
 	case mouseDispatcher::EV_RIGHT_DOWN: {
@@ -283,14 +316,143 @@ bool qdGameScene::mouse_handler(int x, int y, mouseDispatcher::mouseEvent ev) {
 }
 
 qdGameObject *qdGameScene::get_hitted_obj(int x, int y) {
-	for (Std::vector<qdGameObject *>::iterator io = _visible_objects.begin(); io != _visible_objects.end(); ++io) {
-		if (!(*io)->check_flag(QD_OBJ_DISABLE_MOUSE_FLAG) && (*io)->named_object_type() != QD_NAMED_OBJECT_STATIC_OBJ)
-			if ((*io)->hit(x, y))
-				return (*io);
+	if (!_hit_grid.valid || _hit_grid.states_stamp != qdCondition::dependencies_stamp(qdCondition::DEPENDS_ON_OBJECT_STATES))
+		build_hit_grid();
+
+	const HitGrid &grid = _hit_grid;
+
+	// Кандидаты из ячейки под курсором и объекты без области
+	// сливаются по номерам, то есть проверяются от ближних к дальним.
+	int cell_begin = 0;
+	int cell_end = 0;
+	if (x >= grid.origin.x && y >= grid.origin.y) {
+		int cx = (x - grid.origin.x) / grid.cell_size;
+		int cy = (y - grid.origin.y) / grid.cell_size;
+		if (cx < grid.size_x && cy < grid.size_y) {
+			int cell = cx + cy * grid.size_x;
+			cell_begin = grid.cells[cell];
+			cell_end = grid.cells[cell + 1];
+		}
+	}
+
+	uint unbounded_idx = 0;
+	while (cell_begin < cell_end || unbounded_idx < grid.unbounded.size()) {
+		int idx;
+		if (unbounded_idx >= grid.unbounded.size() || (cell_begin < cell_end && grid.objects[cell_begin] < grid.unbounded[unbounded_idx]))
+			idx = grid.objects[cell_begin++];
+		else
+			idx = grid.unbounded[unbounded_idx++];
+
+		qdGameObject *p = _visible_objects[idx];
+		if (!p->check_flag(QD_OBJ_DISABLE_MOUSE_FLAG) && p->named_object_type() != QD_NAMED_OBJECT_STATIC_OBJ)
+			if (p->hit(x, y))
+				return p;
 	}
+
 	return NULL;
 }
 
+//! Размер ячейки сетки поиска объектов под мышью.
+static const int HIT_GRID_CELL_SIZE = 64;
+//! Максимальное количество ячеек сетки по каждой из осей.
+static const int HIT_GRID_MAX_CELLS = 64;
+//! Запас вокруг области объекта на ошибки округления в hit().
+static const int HIT_GRID_BORDER = 2;
+
+void qdGameScene::build_hit_grid() {
+	HitGrid &grid = _hit_grid;
+
+	grid.cells.clear();
+	grid.objects.clear();
+	grid.unbounded.clear();
+	grid.regions.resize(_visible_objects.size());
+
+	int min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+	bool has_regions = false;
+
+	for (uint i = 0; i < _visible_objects.size(); i++) {
+		const qdGameObject *p = _visible_objects[i];
+		grid.regions[i] = grScreenRegion_EMPTY;
+
+		if (p->named_object_type() == QD_NAMED_OBJECT_STATIC_OBJ)
+			continue;
+
+		// Маски проверяют попадание по своему контуру, а не по анимации.
+		if (p->named_object_type() == QD_NAMED_OBJECT_ANIMATED_OBJ) {
+			const qdGameObjectState *st = static_cast<const qdGameObjectAnimated *>(p)->get_cur_state();
+			if (st && st->state_type() == qdGameObjectState::STATE_MASK) {
+				grid.unbounded.push_back(i);
+				continue;
+			}
+		}
+
+		grScreenRegion reg = p->screen_region();
+		if (reg.is_empty())
+			continue;
+
+		grid.regions[i] = reg;
+
+		if (!has_regions) {
+			min_x = reg.min_x();
+			min_y = reg.min_y();
+			max_x = reg.max_x();
+			max_y = reg.max_y();
+			has_regions = true;
+		} else {
+			min_x = MIN(min_x, reg.min_x());
+			min_y = MIN(min_y, reg.min_y());
+			max_x = MAX(max_x, reg.max_x());
+			max_y = MAX(max_y, reg.max_y());
+		}
+	}
+
+	grid.origin = Vect2i(min_x - HIT_GRID_BORDER, min_y - HIT_GRID_BORDER);
+
+	int sx = max_x - min_x + HIT_GRID_BORDER * 2 + 1;
+	int sy = max_y - min_y + HIT_GRID_BORDER * 2 + 1;
+
+	grid.cell_size = MAX(HIT_GRID_CELL_SIZE, MAX(sx, sy) / HIT_GRID_MAX_CELLS + 1);
+	grid.size_x = has_regions ? sx / grid.cell_size + 1 : 0;
+	grid.size_y = has_regions ? sy / grid.cell_size + 1 : 0;
+
+	grid.cells.resize(grid.size_x * grid.size_y + 1, 0);
+
+	// Два прохода: подсчет объектов в ячейках, затем раскладка по ячейкам.
+	for (int pass = 0; pass < 2; pass++) {
+		for (uint i = 0; i < grid.regions.size(); i++) {
+			const grScreenRegion &reg = grid.regions[i];
+			if (reg.is_empty())
+				continue;
+
+			int x0 = (reg.min_x() - HIT_GRID_BORDER - grid.origin.x) / grid.cell_size;
+			int y0 = (reg.min_y() - HIT_GRID_BORDER - grid.origin.y) / grid.cell_size;
+			int x1 = (reg.max_x() + HIT_GRID_BORDER - grid.origin.x) / grid.cell_size;
+			int y1 = (reg.max_y() + HIT_GRID_BORDER - grid.origin.y) / grid.cell_size;
+
+			for (int y = y0; y <= y1; y++) {
+				for (int x = x0; x <= x1; x++) {
+					int cell = x + y * grid.size_x;
+					if (!pass)
+						grid.cells[cell + 1]++;
+					else
+						grid.objects[grid.fill[cell]++] = i;
+				}
+			}
+		}
+
+		if (!pass) {
+			for (uint i = 1; i < grid.cells.size(); i++)
+				grid.cells[i] += grid.cells[i - 1];
+
+			grid.objects.resize(grid.cells.back());
+			grid.fill = grid.cells;
+		}
+	}
+
+	grid.states_stamp = qdCondition::dependencies_stamp(qdCondition::DEPENDS_ON_OBJECT_STATES);
+	grid.valid = true;
+}
+
 void qdGameScene::load_script(const xml::tag *p) {
 	load_conditions_script(p);
 	qdGameDispatcherBase::load_script_body(p);
@@ -432,6 +594,8 @@ bool qdGameScene::save_script(Common::WriteStream &fh, int indent) const {
 }
 
 int qdGameScene::load_resources() {
+	QD_TRACE_SCOPE_DETAIL("load_resources", name());
+
 	debug("[%d] Loading scene \"%s\"", g_system->getMillis(), transCyrillic(name()));
 
 	int total_size = get_resources_size();
@@ -526,6 +690,18 @@ int qdGameScene::get_resources_size() {
 	return object_list().size() + qdGameDispatcherBase::get_resources_size();
 }
 
+void qdGameScene::memory_stats(qdResourceMemoryStats &stats) const {
+	qdGameDispatcherBase::memory_stats(stats);
+
+	for (auto &io : object_list()) {
+		if (io->named_object_type() == QD_NAMED_OBJECT_STATIC_OBJ)
+			stats.add_resource(static_cast<const qdGameObjectStatic *>(io)->get_sprite());
+	}
+
+	if (const qdGameDispatcher *dp = qdGameDispatcher::get_dispatcher())
+		dp->registered_resources_memory_stats(stats, this);
+}
+
 bool qdGameScene::activate() {
 	debugC(3, kDebugLog, "Activation of the scene, %s", transCyrillic(name()));
 	_camera.quant(0.0f);
@@ -533,6 +709,11 @@ bool qdGameScene::activate() {
 	// During scene activation all the followers are moved to the normal state
 	follow_pers_init(qdGameObjectMoving::FOLLOW_DONE);
 
+	_path_requests.clear();
+
+	// Object footprints are rebuilt from scratch by the next init_objects_grid()
+	_camera.reset_grid_footprints();
+
 	for (qdGameObjectList::const_iterator it = object_list().begin(); it != object_list().end(); ++it) {
 		(*it)->init_grid_zone();
 		if (qdGameObjectAnimated * p = dynamic_cast<qdGameObjectAnimated *>(*it))
@@ -567,6 +748,8 @@ bool qdGameScene::deactivate() {
 	if (_minigame)
 		_minigame->end();
 
+	_path_requests.clear();
+
 	return true;
 }
 
@@ -622,23 +805,88 @@ bool qdGameScene::split_global_objects(qdGameObject *obj) {
 	return true;
 }
 
+//! Объекты одинаковой глубины упорядочиваются по их порядку в списке объектов сцены.
 struct qdObjectOrdering {
 	bool operator()(const qdGameObject *p0, const qdGameObject *p1) {
-		return p0->screen_depth() < p1->screen_depth();
+		if (p0->screen_depth() != p1->screen_depth())
+			return p0->screen_depth() < p1->screen_depth();
+
+		return p0->visible_list_order() < p1->visible_list_order();
 	}
 };
 
+//! Сортировка вставками, на почти упорядоченном списке работает за линейное время.
+static void sort_visible_objects(Std::vector<qdGameObject *> &objects) {
+	qdObjectOrdering less;
+
+	for (uint i = 1; i < objects.size(); i++) {
+		qdGameObject *p = objects[i];
+
+		uint j = i;
+		for (; j > 0 && less(p, objects[j - 1]); j--)
+			objects[j] = objects[j - 1];
+
+		objects[j] = p;
+	}
+}
+
 bool qdGameScene::init_visible_objects_list() {
 	_visible_objects.clear();
 
+	int order = 0;
 	for (auto &it : object_list()) {
+		it->set_visible_list_order(order++);
 		it->update_screen_pos();
 		if (it->is_visible() && !it->check_flag(QD_OBJ_SCREEN_COORDS_FLAG)) {
 			_visible_objects.push_back(it);
+			it->set_in_visible_list(true);
+		} else
+			it->set_in_visible_list(false);
+	}
+
+	sort_visible_objects(_visible_objects);
+	_visible_objects_scene = this;
+	invalidate_hit_grid();
+
+	return true;
+}
+
+bool qdGameScene::update_visible_objects_list() {
+	if (_visible_objects_scene != this)
+		return init_visible_objects_list();
+
+	bool list_changed = false;
+	bool order_changed = false;
+
+	for (auto &it : object_list()) {
+		float depth = it->screen_depth();
+		it->update_screen_pos();
+
+		bool visible = it->is_visible() && !it->check_flag(QD_OBJ_SCREEN_COORDS_FLAG);
+		if (visible != it->is_in_visible_list()) {
+			if (visible)
+				_visible_objects.push_back(it);
+
+			it->set_in_visible_list(visible);
+			list_changed = true;
+		} else if (visible && depth != it->screen_depth())
+			order_changed = true;
+	}
+
+	if (list_changed) {
+		uint count = 0;
+		for (uint i = 0; i < _visible_objects.size(); i++) {
+			if (_visible_objects[i]->is_in_visible_list())
+				_visible_objects[count++] = _visible_objects[i];
 		}
+		_visible_objects.resize(count);
 	}
 
-	Common::sort(_visible_objects.begin(), _visible_objects.end(), qdObjectOrdering());
+	if (list_changed || order_changed)
+		sort_visible_objects(_visible_objects);
+
+	// Экранные координаты объектов обновились.
+	invalidate_hit_grid();
 
 	return true;
 }
@@ -646,6 +894,8 @@ bool qdGameScene::init_visible_objects_list() {
 bool qdGameScene::add_object(qdGameObject *p) {
 	if (_objects.add_object(p)) {
 		p->set_owner(this);
+		if (_visible_objects_scene == this)
+			_visible_objects_scene = NULL;
 		return true;
 	}
 	return false;
@@ -658,6 +908,8 @@ bool qdGameScene::rename_object(qdGameObject *p, const char *name) {
 bool qdGameScene::remove_object(const char *name) {
 
 	if (_objects.remove_object(name)) {
+		if (_visible_objects_scene == this)
+			_visible_objects_scene = NULL;
 		return true;
 	}
 	return false;
@@ -665,6 +917,10 @@ bool qdGameScene::remove_object(const char *name) {
 
 bool qdGameScene::remove_object(qdGameObject *p) {
 	if (_objects.remove_object(p)) {
+		if (p->named_object_type() == QD_NAMED_OBJECT_MOVING_OBJ)
+			cancel_path_request(static_cast<qdGameObjectMoving *>(p));
+		if (_visible_objects_scene == this)
+			_visible_objects_scene = NULL;
 		return true;
 	}
 	return false;
@@ -969,7 +1225,7 @@ void qdGameScene::pre_redraw() {
 	qdGameDispatcher *dp = qdGameDispatcher::get_dispatcher();
 	if (!dp) return;
 
-	init_visible_objects_list();
+	update_visible_objects_list();
 
 	if (!dp->need_full_redraw()) {
 		if (qdGameConfig::get_config().show_fps()) {
@@ -992,10 +1248,13 @@ void qdGameScene::pre_redraw() {
 	}
 
 	if (qdGameConfig::get_config().show_fps()) {
-		if (fps_counter()->fps_value() > 0.0f)
-			snprintf(_fps_string, 255, "%.1f fps", fps_counter()->fps_value());
-		else
-			snprintf(_fps_string, 255, "--");
+		// Времена кадра, логического кванта и отрисовки в мс: p50/p90/p99/max
+		const fpsCounter *fps = fps_counter();
+		snprintf(_fps_string, 255, "%s\nframe  %s\nlogic  %s\nredraw %s",
+			fps->fps_value() > 0.0f ? Common::String::format("%.1f fps", fps->fps_value()).c_str() : "--",
+			fps->frame_times().to_string().c_str(),
+			fps->logic_times().to_string().c_str(),
+			fps->redraw_times().to_string().c_str());
 
 		int sx = grDispatcher::instance()->textWidth(_fps_string);
 		int sy = grDispatcher::instance()->textHeight(_fps_string);
@@ -1258,7 +1517,10 @@ void qdGameScene::follow_implement_update_path() {
 			// Пытаемся найти путь, который будет идти непосредственно к цели (lock_target = true)
 			// иначе будет плохо следовать, довольствясь подоходом к краю препятствия
 
-			if (follow_path_seek((*it), true))
+			if (g_engine->_asyncPathfinding) {
+				// Условие следования меняется, когда станет известен результат поиска
+				request_path(*it, _selected_object->last_move_order(), true, true, qdGameObjectMoving::FOLLOW_WAIT, qdGameObjectMoving::FOLLOW_MOVING);
+			} else if (follow_path_seek((*it), true))
 				(*it)->set_follow_condition(qdGameObjectMoving::FOLLOW_MOVING);
 			else
 				(*it)->set_follow_condition(qdGameObjectMoving::FOLLOW_WAIT);
@@ -1305,12 +1567,17 @@ void qdGameScene::follow_wakening() {
 				if ((*it1) != _selected_object) {
 					dist_vec = _selected_object->R() - (*it1)->R();
 					// Если достаточно далеко от следующего, то не учитываем занятое активным при поиске пути
-					if (dist_vec.norm2() > sqr(_selected_object->collision_radius() + 10 + (*it1)->collision_radius()))
-						_selected_object->set_grid_zone_attributes(sGridCell::CELL_SELECTED);
+					bool avoid_active = dist_vec.norm2() > sqr(_selected_object->collision_radius() + 10 + (*it1)->collision_radius());
+					if (g_engine->_asyncPathfinding) {
+						request_path(*it1, _selected_object->last_move_order(), false, avoid_active);
+					} else {
+						if (avoid_active)
+							_selected_object->set_grid_zone_attributes(sGridCell::CELL_SELECTED);
 
-					follow_path_seek(*it1, false);
+						follow_path_seek(*it1, false);
 
-					_selected_object->drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
+						_selected_object->drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
+					}
 					any_move = true;
 				}
 
@@ -1359,12 +1626,17 @@ void qdGameScene::follow_wakening() {
 				if ((*it) != _selected_object) {
 					Vect3f dist_vec = _selected_object->R() - (*it)->R();
 					// Если достаточно далеко от следующего, то не учитываем занятое активным при поиске пути
-					if (dist_vec.norm2() > sqr(_selected_object->collision_radius() + 10 + (*it)->collision_radius()))
-						_selected_object->set_grid_zone_attributes(sGridCell::CELL_SELECTED);
+					bool avoid_active = dist_vec.norm2() > sqr(_selected_object->collision_radius() + 10 + (*it)->collision_radius());
+					if (g_engine->_asyncPathfinding) {
+						request_path(*it, _selected_object->last_move_order(), false, avoid_active);
+					} else {
+						if (avoid_active)
+							_selected_object->set_grid_zone_attributes(sGridCell::CELL_SELECTED);
 
-					follow_path_seek(*it, false);
+						follow_path_seek(*it, false);
 
-					_selected_object->drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
+						_selected_object->drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
+					}
 					any_move = true;
 				}
 
@@ -1639,6 +1911,75 @@ bool qdGameScene::get_files_list(qdFileNameList &files_to_copy, qdFileNameList &
 }
 
 
+bool qdGameScene::request_path(qdGameObjectMoving *p, const Vect3f &target, bool lock_target, bool avoid_active, int fail_follow_condition, int success_follow_condition) {
+	PathRequest req;
+	req.object = p;
+	req.target = target;
+	req.lock_target = lock_target;
+	req.avoid_active = avoid_active;
+	req.fail_follow_condition = fail_follow_condition;
+	req.success_follow_condition = success_follow_condition;
+
+	if (!g_engine->_asyncPathfinding)
+		return find_requested_path(req);
+
+	// Повторный запрос не уходит в конец очереди, иначе персонажи, запрашивающие
+	// путь каждый квант, могут не дождаться обработки.
+	for (Std::vector<PathRequest>::iterator it = _path_requests.begin(); it != _path_requests.end(); ++it) {
+		if (it->object == p) {
+			*it = req;
+			debugC(3, kDebugMovement, "qdGameScene::request_path(): %s updated", transCyrillic(p->name()));
+			return true;
+		}
+	}
+
+	_path_requests.push_back(req);
+
+	debugC(3, kDebugMovement, "qdGameScene::request_path(): %s queued, %d pending", transCyrillic(p->name()), _path_requests.size());
+	return true;
+}
+
+void qdGameScene::cancel_path_request(const qdGameObjectMoving *p) {
+	for (Std::vector<PathRequest>::iterator it = _path_requests.begin(); it != _path_requests.end(); ++it) {
+		if (it->object == p) {
+			_path_requests.erase(it);
+			return;
+		}
+	}
+}
+
+bool qdGameScene::find_requested_path(const PathRequest &req) {
+	bool avoid_active = req.avoid_active && _selected_object && _selected_object != req.object;
+	if (avoid_active)
+		_selected_object->set_grid_zone_attributes(sGridCell::CELL_SELECTED);
+
+	bool result = req.object->move(req.target, req.lock_target);
+
+	if (avoid_active)
+		_selected_object->drop_grid_zone_attributes(sGridCell::CELL_SELECTED);
+
+	if (!result && req.fail_follow_condition != -1)
+		req.object->set_follow_condition(req.fail_follow_condition);
+	if (result && req.success_follow_condition != -1)
+		req.object->set_follow_condition(req.success_follow_condition);
+
+	return result;
+}
+
+void qdGameScene::path_requests_quant() {
+	// Запросы сверх лимита ждут следующего кванта, порядок обработки не зависит от времени.
+	for (int i = 0; i < PATH_REQUESTS_PER_QUANT && !_path_requests.empty(); i++) {
+		PathRequest req = _path_requests.front();
+		_path_requests.erase(_path_requests.begin());
+
+		if (!req.object->can_move())
+			continue;
+
+		debugC(3, kDebugMovement, "qdGameScene::path_requests_quant(): %s", transCyrillic(req.object->name()));
+		find_requested_path(req);
+	}
+}
+
 void qdGameScene::personages_quant() {
 	for (personages_container_t::const_iterator it = _personages.begin(); it != _personages.end(); ++it) {
 		if ((*it)->button()) {
@@ -134,6 +134,21 @@ public:
 	}
 	bool change_active_personage(void);
 
+	//! Ставит в очередь поиск пути для персонажа.
+	/**
+	В синхронном режиме путь ищется сразу. В асинхронном (QDEngineEngine::_asyncPathfinding)
+	запрос обрабатывается в начале следующего кванта, до тех пор персонаж продолжает
+	текущее движение. Повторный запрос для того же персонажа заменяет предыдущий,
+	сохраняя его место в очереди.
+
+	avoid_active - не проходить через клетки активного персонажа,
+	fail_follow_condition - условие следования, выставляемое при неудаче (-1 - не менять),
+	success_follow_condition - условие следования, выставляемое, если путь найден (-1 - не менять).
+	*/
+	bool request_path(qdGameObjectMoving *p, const Vect3f &target, bool lock_target, bool avoid_active = false, int fail_follow_condition = -1, int success_follow_condition = -1);
+	//! Убирает из очереди запрос на поиск пути для персонажа.
+	void cancel_path_request(const qdGameObjectMoving *p);
+
 	bool set_personage_button(qdInterfaceButton *p);
 
 	bool add_grid_zone(qdGridZone *p);
@@ -207,6 +222,9 @@ public:
 
 	int get_resources_size();
 
+	//! Учитывает в stats также спрайты статических объектов и анимации, загруженные для состояний объектов сцены.
+	void memory_stats(qdResourceMemoryStats &stats) const;
+
 	void inc_zone_update_count() {
 		_zone_update_count++;
 	}
@@ -286,16 +304,78 @@ private:
 
 	uint32 _zone_update_count;
 
+	//! Отрисовываемые объекты, упорядоченные по глубине.
 	static Std::vector<qdGameObject *> _visible_objects;
+	//! Сцена, для которой построен _visible_objects.
+	static const qdGameScene *_visible_objects_scene;
+
+	//! Сетка на экране для поиска объектов под мышью, см. get_hitted_obj().
+	/**
+	Строится по screen_region() объектов из _visible_objects при первом
+	поиске после обновления списка, кванта сцены или смены состояний объектов.
+	*/
+	struct HitGrid {
+		bool valid;
+		//! Отметка о версии состояний объектов, для которой построена сетка.
+		uint32 states_stamp;
+
+		Vect2i origin;
+		int cell_size;
+		int size_x;
+		int size_y;
+
+		//! Начала списков ячеек в objects, size_x * size_y + 1 элементов.
+		Std::vector<int> cells;
+		//! Номера объектов в _visible_objects по ячейкам, в порядке возрастания.
+		Std::vector<int> objects;
+		//! Объекты, область которых заранее неизвестна (маски), проверяются всегда.
+		Std::vector<int> unbounded;
+
+		Std::vector<grScreenRegion> regions;
+		Std::vector<int> fill;
+	};
+	static HitGrid _hit_grid;
+
+	void build_hit_grid();
+
+	//! Отложенный запрос на поиск пути.
+	struct PathRequest {
+		qdGameObjectMoving *object;
+		Vect3f target;
+		bool lock_target;
+		bool avoid_active;
+		int fail_follow_condition;
+		int success_follow_condition;
+	};
+
+	//! Очередь отложенных запросов на поиск пути, обрабатывается по порядку поступления.
+	Std::vector<PathRequest> _path_requests;
+
+	//! Максимальное количество отложенных поисков пути за квант.
+	static const int PATH_REQUESTS_PER_QUANT = 2;
 
 	static grScreenRegion _fps_region;
 	static grScreenRegion _fps_region_last;
 	static char _fps_string[255];
 
+	//! Полное построение списка отрисовываемых объектов.
 	bool init_visible_objects_list();
+	//! Обновление списка отрисовываемых объектов.
+	/**
+	Добавляет появившиеся объекты, убирает скрытые и досортировывает
+	список вставками, если поменялся его состав или глубина объектов.
+	*/
+	bool update_visible_objects_list();
+	//! Сетка поиска объектов под мышью будет перестроена при следующем поиске.
+	static void invalidate_hit_grid() {
+		_hit_grid.valid = false;
+	}
 	void update_mouse_cursor();
 
 	void personages_quant();
+	//! Обработка отложенных запросов на поиск пути.
+	void path_requests_quant();
+	bool find_requested_path(const PathRequest &req);
 
 	//! Инициализирует персонажей, участвующих в следовании
 	void follow_pers_init(int follow_cond);
@@ -40,7 +40,8 @@ qdGridZone::qdGridZone() : qdContour(CONTOUR_POLYGON),
 	_state_off(false),
 	_update_timer(0),
 	_shadow_alpha(QD_NO_SHADOW_ALPHA),
-	_shadow_color(0) {
+	_shadow_color(0),
+	_cell_mask_row_words(0) {
 	_state_on.set_owner(this);
 	_state_off.set_owner(this);
 }
@@ -53,7 +54,9 @@ qdGridZone::qdGridZone(const qdGridZone &gz) : qdNamedObject(gz), qdContour(gz),
 	_state_off(gz._state_off),
 	_update_timer(gz._update_timer),
 	_shadow_alpha(gz._shadow_alpha),
-	_shadow_color(gz._shadow_color) {
+	_shadow_color(gz._shadow_color),
+	_cell_mask(gz._cell_mask),
+	_cell_mask_row_words(gz._cell_mask_row_words) {
 }
 
 qdGridZone::~qdGridZone() {
@@ -77,6 +80,9 @@ qdGridZone &qdGridZone::operator = (const qdGridZone &gz) {
 	_shadow_alpha = gz._shadow_alpha;
 	_shadow_color = gz._shadow_color;
 
+	_cell_mask = gz._cell_mask;
+	_cell_mask_row_words = gz._cell_mask_row_words;
+
 	return *this;
 }
 
@@ -106,6 +112,7 @@ bool qdGridZone::load_script(const xml::tag *p) {
 		case QDSCR_GRID_ZONE_CONTOUR:
 		case QDSCR_CONTOUR_POLYGON:
 			qdContour::load_script(&*it);
+			_cell_mask.clear();
 			break;
 		case QDSCR_GRID_ZONE_SHADOW_COLOR:
 			xml::tag_buffer(*it) > _shadow_color;
@@ -185,41 +192,27 @@ bool qdGridZone::apply_zone() const {
 	qdCamera *camera = static_cast<qdGameScene *>(owner())->get_camera();
 	if (!camera) return false;
 
+	if (!update_cell_mask()) return false;
+
 	Vect2s pos = mask_pos();
 	pos.x -= mask_size().x / 2;
 	pos.y -= mask_size().y / 2;
 
-//	const byte* mask_ptr = mask_data();
-
-	if (_state) {
-		for (int y = 0; y < mask_size().y; y++) {
-			for (int x = 0; x < mask_size().x; x++) {
-				if (is_inside(pos + Vect2s(x, y))) {
-//				if(*mask_ptr++){
-					if (sGridCell * p = camera->get_cell(pos + Vect2s(x, y))) {
-						p->make_walkable();
-						p->set_height(_height);
-					}
-				}
-			}
-		}
-	} else {
-		for (int y = 0; y < mask_size().y; y++) {
-			for (int x = 0; x < mask_size().x; x++) {
-				if (is_inside(pos + Vect2s(x, y))) {
-//				if(*mask_ptr++){
-					if (sGridCell * p = camera->get_cell(pos + Vect2s(x, y))) {
-						p->make_impassable();
-						p->set_height(0);
-					}
-				}
-			}
-		}
-	}
+	if (_state)
+		camera->drop_grid_mask_attributes(pos, mask_size(), &_cell_mask[0], _cell_mask_row_words, sGridCell::CELL_IMPASSABLE);
+	else
+		camera->set_grid_mask_attributes(pos, mask_size(), &_cell_mask[0], _cell_mask_row_words, sGridCell::CELL_IMPASSABLE);
 
 	return true;
 }
 
+bool qdGridZone::update_cell_mask() const {
+	if (!_cell_mask.empty())
+		return true;
+
+	return rasterize(_cell_mask, _cell_mask_row_words) && !_cell_mask.empty();
+}
+
 bool qdGridZone::set_state(bool st) {
 	_state = st;
 
@@ -241,33 +234,17 @@ bool qdGridZone::select(qdCamera *camera, bool bSelect) const {
 	if (is_mask_empty())
 		return false;
 
+	if (!update_cell_mask())
+		return false;
+
 	Vect2s pos = mask_pos();
 	pos.x -= mask_size().x / 2;
 	pos.y -= mask_size().y / 2;
 
-//	const byte* mask_ptr = mask_data();
-
-	if (bSelect) {
-		for (int y = 0; y < mask_size().y; y++) {
-			for (int x = 0; x < mask_size().x; x++) {
-				if (is_inside(pos + Vect2s(x, y))) {
-//				if(*mask_ptr++){
-					if (sGridCell * p = camera->get_cell(pos + Vect2s(x, y)))
-						p->select();
-				}
-			}
-		}
-	} else {
-		for (int y = 0; y < mask_size().y; y++) {
-			for (int x = 0; x < mask_size().x; x++) {
-				if (is_inside(pos + Vect2s(x, y))) {
-//				if(*mask_ptr++){
-					if (sGridCell * p = camera->get_cell(pos + Vect2s(x, y)))
-						p->deselect();
-				}
-			}
-		}
-	}
+	if (bSelect)
+		camera->set_grid_mask_attributes(pos, mask_size(), &_cell_mask[0], _cell_mask_row_words, sGridCell::CELL_SELECTED);
+	else
+		camera->drop_grid_mask_attributes(pos, mask_size(), &_cell_mask[0], _cell_mask_row_words, sGridCell::CELL_SELECTED);
 
 	return true;
 }
@@ -152,7 +152,15 @@ private:
 	//! Состояние выключающее зону.
 	qdGridZoneState _state_off;
 
+	//! Маска клеток сетки, занимаемых зоной, см. qdContour::rasterize().
+	mutable Std::vector<uint64> _cell_mask;
+	//! Количество слов на строку в _cell_mask.
+	mutable int _cell_mask_row_words;
+
 	bool apply_zone() const;
+
+	//! Растеризация контура зоны в _cell_mask, если она еще не построена.
+	bool update_cell_mask() const;
 };
 
 } // namespace QDEngine
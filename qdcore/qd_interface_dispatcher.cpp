@@ -710,6 +710,11 @@ void qdInterfaceDispatcher::update_personage_buttons() {
 		_cur_screen->update_personage_buttons();
 }
 
+void qdInterfaceDispatcher::memory_stats(qdResourceMemoryStats &stats) const {
+	for (resource_container_t::resource_list_t::const_iterator it = _resources.resource_list().begin(); it != _resources.resource_list().end(); ++it)
+		stats.add_resource(*it);
+}
+
 #ifdef __QD_DEBUG_ENABLE__
 bool qdInterfaceDispatcher::get_resources_info(qdResourceInfoContainer &infos) const {
 	for (resource_container_t::resource_list_t::const_iterator it = _resources.resource_list().begin(); it != _resources.resource_list().end(); ++it) {
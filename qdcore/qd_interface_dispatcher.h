@@ -268,6 +268,9 @@ public:
 	bool get_resources_info(qdResourceInfoContainer &infos) const;
 #endif
 
+	//! Учитывает в stats все загруженные ресурсы интерфейса.
+	void memory_stats(qdResourceMemoryStats &stats) const;
+
 private:
 
 	//! Активный интерфейсный экран.
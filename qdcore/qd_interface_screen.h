@@ -91,6 +91,10 @@ public:
 	bool has_references(const qdResource *p) const {
 		return _resources.is_registered(p);
 	}
+	//! Учитывает в stats загруженные ресурсы экрана.
+	void memory_stats(qdResourceMemoryStats &stats) const {
+		_resources.memory_stats(stats);
+	}
 
 	//! Прячет элемент.
 	bool hide_element(const char *element_name, bool temporary_hide = true);
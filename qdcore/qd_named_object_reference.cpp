@@ -32,12 +32,13 @@
 namespace QDEngine {
 
 int qdNamedObjectReference::_objects_counter = 0;
+uint32 qdNamedObjectReference::_objects_generation = 1;
 
-qdNamedObjectReference::qdNamedObjectReference() {
+qdNamedObjectReference::qdNamedObjectReference() : _cached_object(NULL), _cache_generation(0) {
 	_objects_counter++;
 }
 
-qdNamedObjectReference::qdNamedObjectReference(int levels, const int *types, const char *const *names) {
+qdNamedObjectReference::qdNamedObjectReference(int levels, const int *types, const char *const *names) : _cached_object(NULL), _cache_generation(0) {
 	_object_types.reserve(levels);
 	_object_names.reserve(levels);
 
@@ -50,11 +51,13 @@ qdNamedObjectReference::qdNamedObjectReference(int levels, const int *types, con
 }
 
 qdNamedObjectReference::qdNamedObjectReference(const qdNamedObjectReference &ref) : _object_types(ref._object_types),
-	_object_names(ref._object_names) {
+	_object_names(ref._object_names),
+	_cached_object(ref._cached_object),
+	_cache_generation(ref._cache_generation) {
 	_objects_counter++;
 }
 
-qdNamedObjectReference::qdNamedObjectReference(const qdNamedObject *p) {
+qdNamedObjectReference::qdNamedObjectReference(const qdNamedObject *p) : _cached_object(NULL), _cache_generation(0) {
 	init(p);
 
 	_objects_counter++;
@@ -69,6 +72,9 @@ qdNamedObjectReference &qdNamedObjectReference::operator = (const qdNamedObjectR
 	_object_types = ref._object_types;
 	_object_names = ref._object_names;
 
+	_cached_object = ref._cached_object;
+	_cache_generation = ref._cache_generation;
+
 	return *this;
 }
 
@@ -101,6 +107,8 @@ bool qdNamedObjectReference::init(const qdNamedObject *p) {
 }
 
 void qdNamedObjectReference::load_script(const xml::tag *p) {
+	_cache_generation = 0;
+
 	for (xml::tag::subtag_iterator it = p->subtags_begin(); it != p->subtags_end(); ++it) {
 		xml::tag_buffer buf(*it);
 		switch (it->ID()) {
@@ -156,6 +164,8 @@ bool qdNamedObjectReference::load_data(Common::SeekableReadStream &fh, int versi
 	debugC(5, kDebugSave, "      qdNamedObjectReference::load_data before: %ld", fh.pos());
 	int nlevels = fh.readSint32LE();
 
+	_cache_generation = 0;
+
 	_object_types.resize(nlevels);
 	_object_names.resize(nlevels);
 
@@ -60,6 +60,7 @@ public:
 	void clear() {
 		_object_types.clear();
 		_object_names.clear();
+		_cache_generation = 0;
 	}
 
 	void load_script(const xml::tag *p);
@@ -74,11 +75,40 @@ public:
 
 	Common::String toString() const;
 
+	//! Возвращает запомненный объект, если с момента поиска списки объектов не менялись.
+	bool cached_object(qdNamedObject *&p) const {
+		if (_cache_generation != _objects_generation)
+			return false;
+
+		p = _cached_object;
+		return true;
+	}
+	//! Запоминает найденный по ссылке объект, см. qdGameDispatcher::get_named_object().
+	void set_cached_object(qdNamedObject *p) const {
+		_cached_object = p;
+		_cache_generation = _objects_generation;
+	}
+
+	//! Отмечает изменение списков объектов, сбрасывает запомненные объекты у всех ссылок.
+	/**
+	Вызывается при добавлении, удалении и переименовании объектов, смене сцены и загрузке сэйва.
+	*/
+	static void objects_changed() {
+		_objects_generation++;
+	}
+
 private:
 
 	Std::vector<int> _object_types;
 	Std::vector<Common::String> _object_names;
 	static int _objects_counter;
+
+	//! Объект, найденный по ссылке.
+	mutable qdNamedObject *_cached_object;
+	//! Значение _objects_generation на момент поиска _cached_object, 0 - поиска не было.
+	mutable uint32 _cache_generation;
+
+	static uint32 _objects_generation;
 };
 
 } // namespace QDEngine
@@ -22,9 +22,14 @@
 #ifndef QDENGINE_QDCORE_QD_OBJECT_LIST_CONTAINER_H
 #define QDENGINE_QDCORE_QD_OBJECT_LIST_CONTAINER_H
 
+#include "common/algorithm.h"
 #include "common/str.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 #include "common/std/list.h"
 
+#include "qdengine/qdcore/qd_named_object_reference.h"
+
 
 namespace QDEngine {
 
@@ -57,14 +62,33 @@ public:
 
 private:
 
+	//! Индекс объектов по именам, без учета регистра - как и при сравнении имен в scumm_stricmp().
+	typedef Common::HashMap<Common::String, T *, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> object_map_t;
+
 	object_list_t _object_list;
+	object_map_t _object_map;
+
+	//! Убирает объект из индекса, возвращает false, если его там не было.
+	bool remove_from_map(const T *p) {
+		if (!p->name()) return false;
+
+		typename object_map_t::iterator it = _object_map.find(p->name());
+		if (it == _object_map.end() || it->_value != p)
+			return false;
+
+		_object_map.erase(it);
+		return true;
+	}
 };
 
 template <class T>
 bool qdObjectListContainer<T>::add_object(T *p) {
 	if (get_object(p->name())) return false;
 	_object_list.push_back(p);
+	if (p->name())
+		_object_map[p->name()] = p;
 
+	qdNamedObjectReference::objects_changed();
 	return true;
 }
 
@@ -72,10 +96,9 @@ template <class T>
 const T *qdObjectListContainer<T>::get_object(const char *name) const {
 	if (!name) return NULL;
 
-	for (typename object_list_t::const_iterator it = _object_list.begin(); it != _object_list.end(); ++it) {
-		if (!scumm_stricmp(name, (*it)->name()))
-			return *it;
-	}
+	typename object_map_t::const_iterator it = _object_map.find(name);
+	if (it != _object_map.end())
+		return it->_value;
 
 	return NULL;
 }
@@ -84,10 +107,9 @@ template <class T>
 T *qdObjectListContainer<T>::get_object(const char *name) {
 	if (!name) return NULL;
 
-	for (typename object_list_t::const_iterator it = _object_list.begin(); it != _object_list.end(); ++it) {
-		if (!scumm_stricmp(name, (*it)->name()))
-			return *it;
-	}
+	typename object_map_t::iterator it = _object_map.find(name);
+	if (it != _object_map.end())
+		return it->_value;
 
 	return NULL;
 }
@@ -97,6 +119,8 @@ bool qdObjectListContainer<T>::remove_object(T *p) {
 	for (typename object_list_t::iterator it = _object_list.begin(); it != _object_list.end(); ++it) {
 		if (*it == p) {
 			_object_list.erase(it);
+			remove_from_map(p);
+			qdNamedObjectReference::objects_changed();
 			return true;
 		}
 	}
@@ -114,7 +138,13 @@ bool qdObjectListContainer<T>::remove_object(const char *name) {
 
 template <class T>
 bool qdObjectListContainer<T>::rename_object(T *p, const char *name) {
+	bool in_list = remove_from_map(p) || Common::find(_object_list.begin(), _object_list.end(), p) != _object_list.end();
+
 	p->set_name(name);
+	if (in_list && p->name())
+		_object_map[p->name()] = p;
+
+	qdNamedObjectReference::objects_changed();
 	return true;
 }
 
@@ -133,6 +163,8 @@ bool qdObjectListContainer<T>::clear() {
 		delete *it;
 
 	_object_list.clear();
+	_object_map.clear();
+	qdNamedObjectReference::objects_changed();
 
 	return true;
 }
@@ -25,6 +25,7 @@
 #include "common/system.h"
 
 #include "qdengine/qdengine.h"
+#include "qdengine/qdcore/qd_named_object_reference.h"
 
 
 namespace QDEngine {
@@ -73,6 +74,7 @@ bool qdObjectMapContainer<T>::add_object(T *p) {
 	_object_map[p->name()] = p;
 	_object_list.push_back(p);
 
+	qdNamedObjectReference::objects_changed();
 	return true;
 }
 
@@ -105,6 +107,7 @@ bool qdObjectMapContainer<T>::remove_object(T *p) {
 			if (im != _object_map.end())
 				_object_map.erase(im);
 
+			qdNamedObjectReference::objects_changed();
 			return true;
 		}
 	}
@@ -128,6 +131,7 @@ bool qdObjectMapContainer<T>::rename_object(T *p, const char *name) {
 		p->set_name(name);
 		_object_map[p->name()] = p;
 
+		qdNamedObjectReference::objects_changed();
 		return true;
 	}
 	return false;
@@ -150,6 +154,7 @@ bool qdObjectMapContainer<T>::clear() {
 		delete *it;
 
 	_object_list.clear();
+	qdNamedObjectReference::objects_changed();
 
 	return true;
 }
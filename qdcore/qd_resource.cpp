@@ -64,6 +64,78 @@ qdResource::file_format_t qdResource::file_format(const char *file_name) {
 	return RES_UNKNOWN;
 }
 
+qdResourceMemoryStats::qdResourceMemoryStats() {
+	for (int i = 0; i < MEM_TYPE_COUNT; i++) {
+		_data_size[i] = 0;
+		_data_count[i] = 0;
+	}
+}
+
+void qdResourceMemoryStats::add_resource(const qdResource *res) {
+	if (!res || !res->is_resource_loaded() || _resources.contains(res))
+		return;
+
+	_resources[res] = true;
+
+	data_type_t type = MEM_OTHER;
+	if (const char *file_name = res->resource_file()) {
+		switch (qdResource::file_format(file_name)) {
+		case qdResource::RES_ANIMATION:
+			type = MEM_ANIMATION;
+			break;
+		case qdResource::RES_SPRITE:
+			type = MEM_SPRITE;
+			break;
+		case qdResource::RES_SOUND:
+			type = MEM_SOUND;
+			break;
+		default:
+			break;
+		}
+	}
+
+	add_data(type, res->resource_data_size());
+}
+
+void qdResourceMemoryStats::add_data(data_type_t type, uint32 size) {
+	_data_size[type] += size;
+	_data_count[type]++;
+}
+
+uint32 qdResourceMemoryStats::total_size() const {
+	uint32 size = 0;
+	for (int i = 0; i < MEM_TYPE_COUNT; i++)
+		size += _data_size[i];
+
+	return size;
+}
+
+Common::String qdResourceMemoryStats::to_string() const {
+	Common::String str;
+	for (int i = 0; i < MEM_TYPE_COUNT; i++) {
+		if (_data_count[i])
+			str += Common::String::format("%s %u KB (%d), ", data_type_name(data_type_t(i)), _data_size[i] / 1024, _data_count[i]);
+	}
+
+	str += Common::String::format("total %u KB", total_size() / 1024);
+	return str;
+}
+
+const char *qdResourceMemoryStats::data_type_name(data_type_t type) {
+	switch (type) {
+	case MEM_ANIMATION:
+		return "animation";
+	case MEM_SPRITE:
+		return "sprite";
+	case MEM_SOUND:
+		return "sound";
+	case MEM_FONT:
+		return "font";
+	default:
+		return "other";
+	}
+}
+
 #ifdef __QD_DEBUG_ENABLE__
 qdResourceInfo::qdResourceInfo(const qdResource *res, const qdNamedObject *owner) : _resource(res), _data_size(0), _resource_owner(owner) {
 	if (_resource)
@@ -22,6 +22,9 @@
 #ifndef QDENGINE_QDCORE_QD_RESOURCE_H
 #define QDENGINE_QDCORE_QD_RESOURCE_H
 
+#include "common/hashmap.h"
+#include "common/hash-ptr.h"
+#include "common/str.h"
 
 
 //! Базовый класс для игровых ресурсов.
@@ -70,9 +73,8 @@ public:
 
 	static file_format_t file_format(const char *file_name);
 
-#ifdef __QD_DEBUG_ENABLE__
+	//! Возвращает объем памяти, занятой данными ресурса, в байтах.
 	virtual uint32 resource_data_size() const = 0;
-#endif
 
 protected:
 
@@ -87,6 +89,52 @@ private:
 	bool _is_loaded;
 };
 
+//! Объем памяти, занятой загруженными ресурсами, по типам.
+/**
+Каждый ресурс учитывается один раз, даже если он добавлен повторно
+(например, общий для нескольких владельцев).
+*/
+class qdResourceMemoryStats {
+public:
+	//! Типы данных.
+	enum data_type_t {
+		MEM_ANIMATION,
+		MEM_SPRITE,
+		MEM_SOUND,
+		MEM_FONT,
+		MEM_OTHER,
+
+		MEM_TYPE_COUNT
+	};
+
+	qdResourceMemoryStats();
+
+	//! Учитывает ресурс, если он загружен и еще не был учтен.
+	void add_resource(const qdResource *res);
+	//! Учитывает данные, не являющиеся ресурсами (шрифты и т.д.).
+	void add_data(data_type_t type, uint32 size);
+
+	uint32 data_size(data_type_t type) const {
+		return _data_size[type];
+	}
+	int data_count(data_type_t type) const {
+		return _data_count[type];
+	}
+	uint32 total_size() const;
+
+	//! Строка вида "animation 1234 KB (10), sprite ..., total 5678 KB".
+	Common::String to_string() const;
+
+	static const char *data_type_name(data_type_t type);
+
+private:
+	uint32 _data_size[MEM_TYPE_COUNT];
+	int _data_count[MEM_TYPE_COUNT];
+
+	//! Уже учтенные ресурсы.
+	Common::HashMap<const qdResource *, bool> _resources;
+};
+
 #ifdef __QD_DEBUG_ENABLE__
 class qdResourceInfo {
 public:
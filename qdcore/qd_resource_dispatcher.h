@@ -109,6 +109,23 @@ public:
 		}
 	}
 
+	//! Учитывает в stats загруженные ресурсы владельца owner (всех владельцев, если NULL).
+	void memory_stats(qdResourceMemoryStats &stats, const T *owner = NULL) const {
+		for (typename handle_container_t::const_iterator it = _handles.begin(); it != _handles.end(); ++it) {
+			if (!owner || it->resource_owner() == owner)
+				stats.add_resource(it->resource());
+		}
+	}
+
+	//! Учитывает в stats загруженные ресурсы владельцев, для которых filter(owner) возвращает true.
+	template<class Filter>
+	void memory_stats_if(qdResourceMemoryStats &stats, const Filter &filter) const {
+		for (typename handle_container_t::const_iterator it = _handles.begin(); it != _handles.end(); ++it) {
+			if (filter(it->resource_owner()))
+				stats.add_resource(it->resource());
+		}
+	}
+
 	//! Загружает в память данные ресурса, если они еще не загружены.
 	bool load_resource(qdResource *res, const T *res_owner) {
 		qdResourceHandle<T> hres(res, res_owner);
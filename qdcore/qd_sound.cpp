@@ -27,6 +27,8 @@
 #include "qdengine/parser/qdscr_parser.h"
 #include "qdengine/qdcore/qd_sound.h"
 #include "qdengine/system/sound/snd_dispatcher.h"
+#include "qdengine/qdcore/util/profiler.h"
+#include "qdengine/qdcore/util/trace_recorder.h"
 
 
 namespace QDEngine {
@@ -52,6 +54,8 @@ bool qdSound::free_resource() {
 bool qdSound::load_resource() {
 	if (_file_name.empty()) return false;
 
+	QD_PROFILE_SCOPE(PROFILE_RESOURCE_LOAD);
+
 	toggle_resource_status(true);
 
 	return _sound.wav_file_load(_file_name.c_str());
@@ -107,6 +111,8 @@ bool qdSound::play(const qdSoundHandle *handle, bool loop, float start_position)
 		debugC(3, kDebugSound, "");
 	}
 
+	QD_TRACE_INSTANT("sound_start", name());
+
 	if (sndDispatcher *p = sndDispatcher::get_dispatcher()) {
 		sndSound sound(&_sound, handle);
 		return p->play_sound(&sound, loop, start_position, _volume);
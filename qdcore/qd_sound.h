@@ -56,11 +56,9 @@ public:
 	const char *resource_file() const {
 		return file_name();
 	}
-#ifdef __QD_DEBUG_ENABLE__
 	uint32 resource_data_size() const {
-		return _sound.data_length();
+		return _sound.data_size();
 	}
-#endif
 
 	//! Возвращает имя файла, в котором хранится звук.
 	const char *file_name() const {
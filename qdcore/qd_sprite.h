@@ -185,11 +185,9 @@ public:
 		if (has_file()) return file();
 		return NULL;
 	}
-#ifdef __QD_DEBUG_ENABLE__
 	uint32 resource_data_size() const {
 		return data_size();
 	}
-#endif
 
 	//! Возвращает область экрана, занимаемую спрайтом.
 	/**
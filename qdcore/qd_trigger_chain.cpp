@@ -29,9 +29,10 @@
 
 namespace QDEngine {
 
-qdTriggerChain::qdTriggerChain() {
+qdTriggerChain::qdTriggerChain() : _active_cursor(-1), _object_index_valid(false) {
 	root_element()->set_id(qdTriggerElement::ROOT_ID);
 	root_element()->set_status(qdTriggerElement::TRIGGER_EL_DONE);
+	root_element()->set_chain(this, -1);
 }
 
 qdTriggerChain::~qdTriggerChain() {
@@ -51,6 +52,80 @@ bool qdTriggerChain::reindex_elements() {
 	return true;
 }
 
+void qdTriggerChain::build_object_index() {
+	_object_index.clear();
+
+	for (auto &it : _elements)
+		add_to_object_index(it);
+
+	_object_index_valid = true;
+}
+
+void qdTriggerChain::add_to_object_index(qdTriggerElementPtr p) {
+	if (!p->object()) return;
+
+	_object_index[p->object()].push_back(p);
+}
+
+void qdTriggerChain::remove_from_object_index(qdTriggerElementPtr p) {
+	if (!p->object()) return;
+
+	object_index_t::iterator it = _object_index.find(p->object());
+	if (it == _object_index.end()) return;
+
+	for (uint i = 0; i < it->_value.size(); i++) {
+		if (it->_value[i] == p) {
+			it->_value.remove_at(i);
+			break;
+		}
+	}
+
+	if (it->_value.empty())
+		_object_index.erase(it);
+}
+
+void qdTriggerChain::update_elements_order() {
+	int order = 0;
+	for (auto &it : _elements)
+		it->set_chain(this, order++);
+}
+
+void qdTriggerChain::build_active_elements() {
+	_active_elements.clear();
+
+	if (root_element()->has_active_child_links())
+		_active_elements.push_back(root_element());
+
+	for (auto &it : _elements) {
+		if (it->has_active_child_links())
+			_active_elements.push_back(it);
+	}
+}
+
+void qdTriggerChain::add_active_element(qdTriggerElementPtr p) {
+	int order = p->chain_order();
+
+	int lo = 0;
+	int hi = _active_elements.size();
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (_active_elements[mid]->chain_order() < order)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < (int)_active_elements.size() && _active_elements[lo] == p)
+		return;
+
+	_active_elements.insert_at(lo, p);
+
+	// Элементы, стоящие раньше текущего, будут обработаны только в следующем кванте,
+	// как и при обходе всех элементов по порядку.
+	if (_active_cursor >= 0 && lo <= _active_cursor)
+		_active_cursor++;
+}
+
 qdTriggerElementPtr qdTriggerChain::search_element(int id) {
 	if (id == qdTriggerElement::ROOT_ID)
 		return root_element();
@@ -69,6 +144,10 @@ qdTriggerElementPtr qdTriggerChain::add_element(qdNamedObject *p) {
 	_elements.push_back(el);
 
 	reindex_elements();
+	update_elements_order();
+
+	if (_object_index_valid)
+		add_to_object_index(el);
 
 	return el;
 }
@@ -92,11 +171,18 @@ bool qdTriggerChain::remove_element(qdTriggerElementPtr p, bool free_mem, bool r
 				}
 			}
 
+			if (_object_index_valid)
+				remove_from_object_index(*it);
+
+			(*it)->set_chain(NULL, 0);
+
 			if (free_mem)
 				delete *it;
 
 			_elements.erase(it);
 			reindex_elements();
+			update_elements_order();
+			build_active_elements();
 
 			return true;
 		}
@@ -120,11 +206,16 @@ bool qdTriggerChain::init_elements() {
 		it->add_object_trigger_reference();
 	}
 
+	// Объекты элементов к этому моменту уже найдены
+	build_object_index();
 
 	return true;
 }
 
 bool qdTriggerChain::is_element_in_list(qdNamedObject const *p) const {
+	if (_object_index_valid && p)
+		return _object_index.contains(p);
+
 	for (auto &it : _elements) {
 		if (it->object() == p)
 			return true;
@@ -133,6 +224,13 @@ bool qdTriggerChain::is_element_in_list(qdNamedObject const *p) const {
 }
 
 bool qdTriggerChain::is_element_in_list(qdTriggerElementConstPtr p) const {
+	if (_object_index_valid) {
+		if (p->chain() == this && p != root_element())
+			return true;
+
+		return p->object() && _object_index.contains(p->object());
+	}
+
 	for (auto &it : _elements) {
 		if (it == p || (it->object() && it->object() == p->object()))
 			return true;
@@ -195,11 +293,16 @@ bool qdTriggerChain::load_script(const xml::tag *p) {
 	for (qdTriggerElementList::iterator it = _elements.begin(); it != _elements.end(); ++it)
 		(*it)->retrieve_link_elements(this);
 
+	_object_index_valid = false;
+
 	for (qdTriggerLinkList::iterator itl = root_element()->children().begin();
 	        itl != root_element()->children().end();
 	        ++itl)
 		itl->activate();
 
+	update_elements_order();
+	build_active_elements();
+
 	return true;
 }
 
@@ -233,10 +336,24 @@ bool qdTriggerChain::save_script(Common::WriteStream &fh, int indent) const {
 }
 
 void qdTriggerChain::quant(float dt) {
-	root_element()->quant(dt);
+	// Обрабатываются только элементы с включенными связями, в том же порядке,
+	// что и при обходе всей цепочки. Элементы, включенные по ходу кванта
+	// и стоящие дальше текущего, обрабатываются в этом же кванте.
+	for (_active_cursor = 0; _active_cursor < (int)_active_elements.size();) {
+		qdTriggerElementPtr el = _active_elements[_active_cursor];
+		el->quant(dt);
+
+		// Список мог быть перестроен заново (reset(), load_data()) во время обработки элемента
+		if (_active_cursor >= (int)_active_elements.size() || _active_elements[_active_cursor] != el)
+			continue;
+
+		if (el->has_active_child_links())
+			_active_cursor++;
+		else
+			_active_elements.remove_at(_active_cursor);
+	}
 
-	for (auto &it : _elements)
-		it->quant(dt);
+	_active_cursor = -1;
 }
 
 bool qdTriggerChain::init_debug_check() {
@@ -259,6 +376,8 @@ bool qdTriggerChain::init_debug_check() {
 			(*it)->debug_set_active();
 	}
 
+	build_active_elements();
+
 	return true;
 }
 
@@ -284,6 +403,9 @@ bool qdTriggerChain::load_data(Common::SeekableReadStream &fh, int save_version)
 			return false;
 		}
 	}
+
+	build_active_elements();
+
 	debugC(4, kDebugSave, "    qdTriggerChain::load_data after: %ld", fh.pos());
 
 	return true;
@@ -317,16 +439,30 @@ void qdTriggerChain::reset() {
 
 	for (qdTriggerLinkList::iterator itl = root_element()->children().begin(); itl != root_element()->children().end(); ++itl)
 		itl->activate();
+
+	build_active_elements();
 }
 
 bool qdTriggerChain::activate_links(const qdNamedObject *from) {
 	bool ret = false;
 
-	for (qdTriggerElementList::const_iterator it = _elements.begin(); it != _elements.end(); ++it) {
+	const qdTriggerElementList *elements = &_elements;
+	if (_object_index_valid && from) {
+		object_index_t::const_iterator idx = _object_index.find(from);
+		if (idx == _object_index.end())
+			return false;
+
+		elements = &idx->_value;
+	}
+
+	for (qdTriggerElementList::const_iterator it = elements->begin(); it != elements->end(); ++it) {
 		if ((*it)->object() == from) {
 			for (qdTriggerLinkList::iterator itl = (*it)->children().begin(); itl != (*it)->children().end(); ++itl)
 				itl->activate();
 
+			if (!(*it)->children().empty())
+				add_active_element(*it);
+
 			ret = true;
 		}
 	}
@@ -337,6 +473,8 @@ bool qdTriggerChain::activate_links(const qdNamedObject *from) {
 bool qdTriggerChain::deactivate_object_triggers(const qdNamedObject *p) {
 	bool ret = false;
 
+	// Здесь индекс не используется: владельцы состояний меняются при активации сцены
+	// (qdGameObjectAnimated::set_states_owner()), а вызывается это только при смене сцены.
 	for (qdTriggerElementList::const_iterator it = _elements.begin(); it != _elements.end(); ++it) {
 		if ((*it)->object()) {
 			const qdNamedObject *obj = (*it)->object()->owner(qdNamedObjectType(p->named_object_type()));
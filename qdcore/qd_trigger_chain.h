@@ -22,6 +22,9 @@
 #ifndef QDENGINE_QDCORE_QD_TRIGGER_CHAIN_H
 #define QDENGINE_QDCORE_QD_TRIGGER_CHAIN_H
 
+#include "common/hashmap.h"
+#include "common/hash-ptr.h"
+
 #include "qdengine/parser/xml_fwd.h"
 #include "qdengine/qdcore/qd_trigger_element.h"
 
@@ -91,12 +94,46 @@ public:
 	bool deactivate_object_triggers(const qdNamedObject *p);
 
 	qdTriggerElementPtr search_element(int id);
+
+	//! Добавляет элемент в список обрабатываемых в quant().
+	/**
+	Вызывается, когда у элемента включается связь к дочернему элементу.
+	Элементы, у которых таких связей не осталось, убираются из списка в quant().
+	*/
+	void add_active_element(qdTriggerElementPtr p);
+
 private:
 
 	qdTriggerElement _root;
 	qdTriggerElementList _elements;
 
+	//! Элементы, у которых есть включенные связи к дочерним элементам.
+	/**
+	Упорядочены по qdTriggerElement::chain_order(), то есть так же,
+	как обходились все элементы цепочки: корень, затем _elements.
+	*/
+	qdTriggerElementList _active_elements;
+	//! Индекс обрабатываемого в quant() элемента в _active_elements, -1 вне quant().
+	int _active_cursor;
+
 	bool reindex_elements();
+
+	typedef Common::HashMap<const qdNamedObject *, qdTriggerElementList> object_index_t;
+
+	//! Элементы цепочки по объектам, на которые они ссылаются.
+	object_index_t _object_index;
+	//! true, если индекс построен, до init_elements() объекты ищутся перебором.
+	bool _object_index_valid;
+
+	//! Полное построение индекса объектов.
+	void build_object_index();
+	void add_to_object_index(qdTriggerElementPtr p);
+	void remove_from_object_index(qdTriggerElementPtr p);
+
+	//! Обновление порядковых номеров элементов, см. qdTriggerElement::chain_order().
+	void update_elements_order();
+	//! Полное построение _active_elements по состояниям связей.
+	void build_active_elements();
 };
 
 } // namespace QDEngine
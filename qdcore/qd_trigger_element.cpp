@@ -106,13 +106,17 @@ bool qdTriggerLink::save_script(Common::WriteStream &fh, int indent) const {
 qdTriggerElement::qdTriggerElement() : _object(NULL),
 	_ID(0),
 	_is_active(false),
-	_status(TRIGGER_EL_INACTIVE) {
+	_status(TRIGGER_EL_INACTIVE),
+	_chain(NULL),
+	_chain_order(0) {
 }
 
 qdTriggerElement::qdTriggerElement(qdNamedObject *p) : _object(p),
 	_ID(0),
 	_is_active(false),
-	_status(TRIGGER_EL_INACTIVE) {
+	_status(TRIGGER_EL_INACTIVE),
+	_chain(NULL),
+	_chain_order(0) {
 	p->add_trigger_reference();
 }
 
@@ -522,6 +526,8 @@ bool qdTriggerElement::conditions_quant(int link_type) {
 			for (auto &it : _children) {
 				it.activate();
 			}
+			if (!_children.empty())
+				add_to_active_list();
 
 			return true;
 		}
@@ -546,14 +552,19 @@ bool qdTriggerElement::activate_links(qdTriggerElementPtr child) {
 
 	if (link_type == -1) return false;
 
+	bool activated = false;
 	for (auto &it : _children) {
 		if (it.type() == link_type) {
 			if (it.element() != child && it.status() == qdTriggerLink::LINK_INACTIVE) {
 				it.activate();
+				activated = true;
 			}
 		}
 	}
 
+	if (activated)
+		add_to_active_list();
+
 	return true;
 }
 
@@ -632,6 +643,8 @@ bool qdTriggerElement::set_child_link_status(qdTriggerElementConstPtr child, qdT
 	if (qdTriggerLink * p = find_child_link(child)) {
 		if (!p->auto_restart() || st == qdTriggerLink::LINK_ACTIVE) {
 			p->set_status(st);
+			if (st == qdTriggerLink::LINK_ACTIVE)
+				add_to_active_list();
 		}
 		return true;
 	}
@@ -775,6 +788,20 @@ void qdTriggerElement::set_status(ElementStatus st) {
 	_status = st;
 }
 
+bool qdTriggerElement::has_active_child_links() const {
+	for (auto &it : _children) {
+		if (it.status() == qdTriggerLink::LINK_ACTIVE)
+			return true;
+	}
+
+	return false;
+}
+
+void qdTriggerElement::add_to_active_list() {
+	if (_chain)
+		_chain->add_active_element(this);
+}
+
 void qdTriggerElement::reset() {
 	for (qdTriggerLinkList::iterator it = _parents.begin(); it != _parents.end(); ++it)
 		it->set_status(qdTriggerLink::LINK_INACTIVE);
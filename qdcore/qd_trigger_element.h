@@ -264,6 +264,25 @@ public:
 	void reset();
 	void deactivate(const qdNamedObject *ignore_object = NULL);
 
+	//! Возвращает true, если хотя бы одна связь к дочерним элементам включена.
+	/**
+	Только у таких элементов quant() что-то делает.
+	*/
+	bool has_active_child_links() const;
+
+	//! Цепочка, которой принадлежит элемент.
+	qdTriggerChain *chain() const {
+		return _chain;
+	}
+	//! Порядковый номер элемента в цепочке (корень - -1), задает порядок обработки в кванте.
+	int chain_order() const {
+		return _chain_order;
+	}
+	void set_chain(qdTriggerChain *p, int order) {
+		_chain = p;
+		_chain_order = order;
+	}
+
 private:
 
 	//! Специальные состояния - используются только в сэйве.
@@ -286,6 +305,12 @@ private:
 	qdTriggerLinkList _parents;
 	qdTriggerLinkList _children;
 
+	qdTriggerChain *_chain;
+	int _chain_order;
+
+	//! Сообщает цепочке, что у элемента могли включиться связи к дочерним элементам.
+	void add_to_active_list();
+
 	bool load_links_script(const xml::tag *p, bool load_parents);
 
 	bool activate_links(qdTriggerElementPtr child);
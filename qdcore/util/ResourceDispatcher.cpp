@@ -73,4 +73,17 @@ void ResourceDispatcher::quant() {
 			break;
 	}
 }
+
+time_type ResourceDispatcher::time_to_next_quant() const {
+	if (users.empty() || start_log)
+		return 0;
+
+	time_type t_min = users.front()->time;
+	for (UserList::const_iterator i = users.begin(); i != users.end(); ++i) {
+		if (t_min > (*i)->time)
+			t_min = (*i)->time;
+	}
+
+	return syncro_timer.time_until(t_min);
+}
 } // namespace QDEngine
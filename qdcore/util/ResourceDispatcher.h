@@ -130,6 +130,8 @@ public:
 		syncro_timer.skip();
 	}
 	void quant();
+	//! Сколько миллисекунд осталось до следующего кванта, 0 - если квант уже пора делать.
+	time_type time_to_next_quant() const;
 	void set_speed(float speed) {
 		syncro_timer.setSpeed(speed);
 	}
@@ -90,6 +90,18 @@ public:
 		_time_speed = speed;
 	}
 
+	// Real milliseconds left until operator()() exceeds t,
+	// 0 if it already does or the timer is not driven by the clock
+	time_type time_until(time_type t) const {
+		if (!_syncro_by_clock || _time_speed <= 0.0f)
+			return 0;
+
+		float due = (float(t) - _time) / _time_speed + _time + _time_offset;
+		float left = due - float(g_system->getMillis());
+
+		return (left > 0.0f) ? time_type(left) + 1 : 0;
+	}
+
 private:
 	float _time;
 	float _time_prev;
@@ -25,6 +25,7 @@
 
 #include "qdengine/qdengine.h"
 #include "qdengine/qdcore/util/WinVideo.h"
+#include "qdengine/qdcore/util/trace_recorder.h"
 
 #include "qdengine/system/graphics/gr_dispatcher.h"
 
@@ -102,7 +103,11 @@ bool winVideo::quant() {
 
 	// Video Playback loop
 	if (_decoder->needsUpdate()) {
-		const Graphics::Surface *frame = _decoder->decodeNextFrame();
+		const Graphics::Surface *frame;
+		{
+			QD_TRACE_SCOPE("video_frame");
+			frame = _decoder->decodeNextFrame();
+		}
 		int frameWidth = _decoder->getWidth();
 		int frameHeight = _decoder->getHeight();
 
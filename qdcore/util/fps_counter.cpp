@@ -26,6 +26,65 @@
 
 namespace QDEngine {
 
+void fpsTimeSeries::add(uint32 time) {
+	if (_size == WINDOW_SIZE)
+		_histogram[MIN<uint32>(_window[_cursor], HISTOGRAM_SIZE - 1)]--;
+	else
+		_size++;
+
+	_window[_cursor] = time;
+	_histogram[MIN<uint32>(time, HISTOGRAM_SIZE - 1)]++;
+
+	if (++_cursor >= WINDOW_SIZE)
+		_cursor = 0;
+}
+
+void fpsTimeSeries::reset() {
+	_cursor = 0;
+	_size = 0;
+
+	memset(_histogram, 0, sizeof(_histogram));
+}
+
+uint32 fpsTimeSeries::percentile(int percent) const {
+	if (!_size)
+		return 0;
+
+	// Номер искомого замера в упорядоченном окне, считая с единицы
+	int rank = (_size * percent + 99) / 100;
+	if (rank < 1)
+		rank = 1;
+
+	int count = 0;
+	for (int i = 0; i < HISTOGRAM_SIZE - 1; i++) {
+		count += _histogram[i];
+		if (count >= rank)
+			return i;
+	}
+
+	return max_value();
+}
+
+uint32 fpsTimeSeries::max_value() const {
+	if (_histogram[HISTOGRAM_SIZE - 1]) {
+		uint32 value = 0;
+		for (int i = 0; i < _size; i++)
+			value = MAX(value, _window[i]);
+		return value;
+	}
+
+	for (int i = HISTOGRAM_SIZE - 2; i >= 0; i--) {
+		if (_histogram[i])
+			return i;
+	}
+
+	return 0;
+}
+
+Common::String fpsTimeSeries::to_string() const {
+	return Common::String::format("%u/%u/%u/%u", percentile(50), percentile(90), percentile(99), max_value());
+}
+
 fpsCounter::fpsCounter(int period) : _start_time(0.0f),
 	_prev_time(0.0f),
 	_period(period),
@@ -46,6 +105,8 @@ bool fpsCounter::quant() {
 	if (_max_frame_time < time - _prev_time)
 		_max_frame_time = time - _prev_time;
 
+	_frame_times.add(uint32(time - _prev_time));
+
 	_frame_count++;
 	_prev_time = time;
 
@@ -79,6 +140,10 @@ void fpsCounter::reset() {
 
 	_min_frame_time = 10000.0f;
 	_max_frame_time = 0.0f;
+
+	_frame_times.reset();
+	_logic_times.reset();
+	_redraw_times.reset();
 }
 
 } // namespace QDEngine
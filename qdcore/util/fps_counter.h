@@ -22,8 +22,51 @@
 #ifndef QDENGINE_QDCORE_UTIL_FPS_COUNTER_H
 #define QDENGINE_QDCORE_UTIL_FPS_COUNTER_H
 
+#include "common/str.h"
+
 namespace QDEngine {
 
+//! Времена (в миллисекундах) за последние WINDOW_SIZE замеров.
+/**
+Вместе со скользящим окном поддерживается гистограмма с шагом в 1 мс,
+по которой считаются перцентили.
+*/
+class fpsTimeSeries {
+public:
+	enum {
+		WINDOW_SIZE = 256,
+		//! Количество ячеек гистограммы, последняя - для всех времен >= HISTOGRAM_SIZE - 1.
+		HISTOGRAM_SIZE = 256
+	};
+
+	fpsTimeSeries() {
+		reset();
+	}
+
+	void add(uint32 time);
+	void reset();
+
+	//! Количество замеров в окне.
+	int size() const {
+		return _size;
+	}
+
+	//! Перцентиль percent (0..100) по окну.
+	uint32 percentile(int percent) const;
+	//! Максимум по окну.
+	uint32 max_value() const;
+
+	//! Строка вида "p50/p90/p99/max".
+	Common::String to_string() const;
+
+private:
+	uint32 _window[WINDOW_SIZE];
+	int _cursor;
+	int _size;
+
+	uint16 _histogram[HISTOGRAM_SIZE];
+};
+
 class fpsCounter {
 public:
 	fpsCounter(int period = 3000);
@@ -50,6 +93,26 @@ public:
 		_period = p;
 	}
 
+	//! Время одного логического кванта.
+	void add_logic_time(uint32 time) {
+		_logic_times.add(time);
+	}
+	//! Время одной отрисовки.
+	void add_redraw_time(uint32 time) {
+		_redraw_times.add(time);
+	}
+
+	//! Время между кадрами.
+	const fpsTimeSeries &frame_times() const {
+		return _frame_times;
+	}
+	const fpsTimeSeries &logic_times() const {
+		return _logic_times;
+	}
+	const fpsTimeSeries &redraw_times() const {
+		return _redraw_times;
+	}
+
 private:
 
 	float _start_time;
@@ -65,6 +128,10 @@ private:
 
 	float _min_frame_time;
 	float _max_frame_time;
+
+	fpsTimeSeries _frame_times;
+	fpsTimeSeries _logic_times;
+	fpsTimeSeries _redraw_times;
 };
 
 
@@ -0,0 +1,152 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/algorithm.h"
+
+#include "qdengine/qdcore/util/profiler.h"
+
+
+namespace QDEngine {
+
+bool qdProfiler::_enabled = false;
+
+qdProfiler::qdProfiler() {
+	reset();
+}
+
+qdProfiler &qdProfiler::instance() {
+	static qdProfiler profiler;
+	return profiler;
+}
+
+void qdProfiler::enable(bool state) {
+	// Незаконченный кадр при включении отбрасываем.
+	if (state && !_enabled) {
+		memset(_frame_time, 0, sizeof(_frame_time));
+		memset(_frame_count, 0, sizeof(_frame_count));
+	}
+
+	_enabled = state;
+}
+
+void qdProfiler::reset() {
+	memset(_frame_time, 0, sizeof(_frame_time));
+	memset(_frame_count, 0, sizeof(_frame_count));
+	memset(_total_time, 0, sizeof(_total_time));
+	memset(_total_count, 0, sizeof(_total_count));
+	memset(_history, 0, sizeof(_history));
+
+	_history_cursor = 0;
+	_history_size = 0;
+	_frames = 0;
+}
+
+void qdProfiler::end_frame() {
+	for (int i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+		_history[i][_history_cursor] = _frame_time[i];
+
+		_total_time[i] += _frame_time[i];
+		_total_count[i] += _frame_count[i];
+
+		_frame_time[i] = 0;
+		_frame_count[i] = 0;
+	}
+
+	if (++_history_cursor >= FRAME_HISTORY_SIZE)
+		_history_cursor = 0;
+	if (_history_size < FRAME_HISTORY_SIZE)
+		_history_size++;
+
+	_frames++;
+}
+
+Common::String qdProfiler::report() const {
+	Common::String str = Common::String::format("Frames: %u, history: %d\n", _frames, _history_size);
+	str += Common::String::format("%-18s %10s %10s %9s %6s %6s %6s\n", "scope", "count", "total ms", "ms/frame", "p50", "p95", "p99");
+
+	uint32 sorted[FRAME_HISTORY_SIZE];
+	for (int i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+		if (!_total_count[i])
+			continue;
+
+		uint32 p50 = 0, p95 = 0, p99 = 0;
+		if (_history_size) {
+			memcpy(sorted, _history[i], _history_size * sizeof(uint32));
+			Common::sort(sorted, sorted + _history_size);
+
+			p50 = sorted[(_history_size - 1) * 50 / 100];
+			p95 = sorted[(_history_size - 1) * 95 / 100];
+			p99 = sorted[(_history_size - 1) * 99 / 100];
+		}
+
+		float per_frame = _frames ? float(_total_time[i]) / float(_frames) : 0.0f;
+
+		str += Common::String::format("%-18s %10llu %10llu %9.2f %6u %6u %6u\n",
+			scope_name(qdProfileScopeID(i)), (unsigned long long)_total_count[i], (unsigned long long)_total_time[i], per_frame, p50, p95, p99);
+	}
+
+	return str;
+}
+
+const char *qdProfiler::scope_name(qdProfileScopeID id) {
+	switch (id) {
+	case PROFILE_DISPATCHER_QUANT:
+		return "dispatcher_quant";
+	case PROFILE_SCENE_QUANT:
+		return "scene_quant";
+	case PROFILE_SCENE_PATH_REQUESTS:
+		return "scene_paths";
+	case PROFILE_SCENE_CONDITIONS:
+		return "scene_conditions";
+	case PROFILE_SCENE_PERSONAGES:
+		return "scene_personages";
+	case PROFILE_SCENE_FOLLOW:
+		return "scene_follow";
+	case PROFILE_SCENE_COLLISIONS:
+		return "scene_collisions";
+	case PROFILE_SCENE_CAMERA:
+		return "scene_camera";
+	case PROFILE_SCENE_OBJECTS:
+		return "scene_objects";
+	case PROFILE_PATHFINDING:
+		return "pathfinding";
+	case PROFILE_CONDITIONS:
+		return "conditions";
+	case PROFILE_REDRAW:
+		return "redraw";
+	case PROFILE_BLIT_SPRITE:
+		return "blit_sprite";
+	case PROFILE_BLIT_SPRITE_RLE:
+		return "blit_sprite_rle";
+	case PROFILE_BLIT_SPRITE_Z:
+		return "blit_sprite_z";
+	case PROFILE_BLIT_SPRITE_RLE_Z:
+		return "blit_sprite_rle_z";
+	case PROFILE_BLIT_TILE:
+		return "blit_tile";
+	case PROFILE_RESOURCE_LOAD:
+		return "resource_load";
+	default:
+		return "unknown";
+	}
+}
+
+} // namespace QDEngine
@@ -0,0 +1,145 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef QDENGINE_QDCORE_UTIL_PROFILER_H
+#define QDENGINE_QDCORE_UTIL_PROFILER_H
+
+#include "common/str.h"
+#include "common/system.h"
+
+namespace QDEngine {
+
+//! Замеряемые участки кода.
+enum qdProfileScopeID {
+	PROFILE_DISPATCHER_QUANT = 0,
+	PROFILE_SCENE_QUANT,
+	PROFILE_SCENE_PATH_REQUESTS,
+	PROFILE_SCENE_CONDITIONS,
+	PROFILE_SCENE_PERSONAGES,
+	PROFILE_SCENE_FOLLOW,
+	PROFILE_SCENE_COLLISIONS,
+	PROFILE_SCENE_CAMERA,
+	PROFILE_SCENE_OBJECTS,
+	PROFILE_PATHFINDING,
+	PROFILE_CONDITIONS,
+	PROFILE_REDRAW,
+	PROFILE_BLIT_SPRITE,
+	PROFILE_BLIT_SPRITE_RLE,
+	PROFILE_BLIT_SPRITE_Z,
+	PROFILE_BLIT_SPRITE_RLE_Z,
+	PROFILE_BLIT_TILE,
+	PROFILE_RESOURCE_LOAD,
+
+	PROFILE_SCOPE_COUNT
+};
+
+//! Встроенный профайлер.
+/**
+Накапливает время и количество входов в участки кода за кадр,
+в end_frame() кадровые суммы складываются в кольцевые буферы,
+по которым считаются перцентили.
+*/
+class qdProfiler {
+public:
+	//! Количество кадров, хранимых в кольцевых буферах.
+	enum {
+		FRAME_HISTORY_SIZE = 512
+	};
+
+	static qdProfiler &instance();
+
+	static bool is_enabled() {
+		return _enabled;
+	}
+	void enable(bool state);
+
+	//! Сброс всей накопленной статистики.
+	void reset();
+
+	void add_sample(qdProfileScopeID id, uint32 time) {
+		_frame_time[id] += time;
+		_frame_count[id]++;
+	}
+
+	//! Конец кадра - перенос кадровых сумм в кольцевые буферы.
+	void end_frame();
+
+	//! Текстовый отчет: количество, суммы и p50/p95/p99 по кадрам для каждого участка.
+	Common::String report() const;
+
+	static const char *scope_name(qdProfileScopeID id);
+
+private:
+	qdProfiler();
+
+	static bool _enabled;
+
+	//! Время и количество входов за текущий кадр.
+	uint32 _frame_time[PROFILE_SCOPE_COUNT];
+	uint32 _frame_count[PROFILE_SCOPE_COUNT];
+
+	//! Общие суммы с момента reset().
+	uint64 _total_time[PROFILE_SCOPE_COUNT];
+	uint64 _total_count[PROFILE_SCOPE_COUNT];
+
+	//! Кадровые суммы времени за последние FRAME_HISTORY_SIZE кадров.
+	uint32 _history[PROFILE_SCOPE_COUNT][FRAME_HISTORY_SIZE];
+	//! Позиция записи в кольцевых буферах.
+	int _history_cursor;
+	//! Количество заполненных элементов кольцевых буферов.
+	int _history_size;
+
+	uint32 _frames;
+};
+
+//! Замер времени выполнения участка кода, от конструктора до деструктора.
+class qdProfileScope {
+public:
+	qdProfileScope(qdProfileScopeID id) : _id(id), _active(qdProfiler::is_enabled()), _start(0) {
+		if (_active)
+			_start = g_system->getMillis();
+	}
+	~qdProfileScope() {
+		if (_active)
+			qdProfiler::instance().add_sample(_id, g_system->getMillis() - _start);
+	}
+
+private:
+	qdProfileScopeID _id;
+	//! false, если при входе профайлер был выключен.
+	bool _active;
+	uint32 _start;
+};
+
+} // namespace QDEngine
+
+//! При определенном __QD_PROFILE_DISABLE__ замеры не компилируются вовсе.
+#ifndef __QD_PROFILE_DISABLE__
+#define QD_PROFILE_CONCAT_IMPL(a, b) a##b
+#define QD_PROFILE_CONCAT(a, b) QD_PROFILE_CONCAT_IMPL(a, b)
+#define QD_PROFILE_SCOPE(id) QDEngine::qdProfileScope QD_PROFILE_CONCAT(qd_profile_scope_, __LINE__)(QDEngine::id)
+#define QD_PROFILE_END_FRAME() do { if (QDEngine::qdProfiler::is_enabled()) QDEngine::qdProfiler::instance().end_frame(); } while (0)
+#else
+#define QD_PROFILE_SCOPE(id)
+#define QD_PROFILE_END_FRAME()
+#endif
+
+#endif // QDENGINE_QDCORE_UTIL_PROFILER_H
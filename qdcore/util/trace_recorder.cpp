@@ -0,0 +1,192 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/debug.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "qdengine/qdengine.h"
+#include "qdengine/qdcore/util/trace_recorder.h"
+
+
+namespace QDEngine {
+
+bool qdTraceRecorder::_recording = false;
+
+qdTraceRecorder::qdTraceRecorder() : _start_time(0),
+	_duration(0),
+	_max_events(0),
+	_depth(0),
+	_closing(false) {
+}
+
+qdTraceRecorder::~qdTraceRecorder() {
+	stop();
+}
+
+qdTraceRecorder &qdTraceRecorder::instance() {
+	static qdTraceRecorder recorder;
+	return recorder;
+}
+
+bool qdTraceRecorder::start(const char *file_name, uint32 duration, uint32 max_events) {
+	stop();
+
+	_file_name = file_name;
+	_events.clear();
+
+	_start_time = g_system->getMillis();
+	_duration = duration;
+	_max_events = max_events;
+
+	_depth = 0;
+	_closing = false;
+
+	_recording = true;
+
+	debugC(1, kDebugLog, "qdTraceRecorder::start(): %s, %u ms, %u events", file_name, duration, max_events);
+	return true;
+}
+
+bool qdTraceRecorder::stop() {
+	if (!_recording)
+		return false;
+
+	_recording = false;
+
+	Common::OutSaveFile *fh = g_system->getSavefileManager()->openForSaving(_file_name, false);
+	if (!fh) {
+		warning("qdTraceRecorder::stop(): can't create %s", _file_name.c_str());
+		_events.clear();
+		return false;
+	}
+
+	fh->writeString("{\"traceEvents\":[\n");
+	for (uint i = 0; i < _events.size(); i++) {
+		const Event &ev = _events[i];
+
+		fh->writeString("{\"name\":\"");
+		write_string(fh, ev.name);
+		fh->writeString(Common::String::format("\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":1,\"tid\":1", ev.phase, (unsigned long long)(ev.time - _start_time) * 1000));
+		if (ev.phase == 'i')
+			fh->writeString(",\"s\":\"g\"");
+		if (!ev.detail.empty()) {
+			fh->writeString(",\"args\":{\"detail\":\"");
+			write_string(fh, (const char *)transCyrillic(ev.detail));
+			fh->writeString("\"}");
+		}
+		fh->writeString(i + 1 < _events.size() ? "},\n" : "}\n");
+	}
+	fh->writeString("],\"displayTimeUnit\":\"ms\"}\n");
+
+	fh->finalize();
+	bool result = !fh->err();
+	delete fh;
+
+	debugC(1, kDebugLog, "qdTraceRecorder::stop(): %d events written to %s", _events.size(), _file_name.c_str());
+
+	_events.clear();
+	return result;
+}
+
+bool qdTraceRecorder::begin(const char *name, const char *detail) {
+	if (!_recording)
+		return false;
+
+	if (!check_limits())
+		return false;
+
+	add_event(name, detail, 'B');
+	_depth++;
+
+	return true;
+}
+
+void qdTraceRecorder::end() {
+	// Конец участка, начатого до старта записи, не пишем
+	if (!_recording || !_depth)
+		return;
+
+	add_event(NULL, NULL, 'E');
+	_depth--;
+
+	if (_closing && !_depth)
+		stop();
+}
+
+void qdTraceRecorder::instant(const char *name, const char *detail) {
+	if (!_recording)
+		return;
+
+	if (check_limits())
+		add_event(name, detail, 'i');
+}
+
+bool qdTraceRecorder::check_limits() {
+	if (!_closing) {
+		if ((_duration && g_system->getMillis() - _start_time >= _duration) || (_max_events && _events.size() + _depth >= _max_events))
+			_closing = true;
+	}
+
+	if (_closing && !_depth)
+		stop();
+
+	return !_closing;
+}
+
+void qdTraceRecorder::add_event(const char *name, const char *detail, char phase) {
+	_events.push_back(Event());
+
+	Event &ev = _events.back();
+	ev.name = name;
+	if (detail)
+		ev.detail = detail;
+	ev.time = g_system->getMillis();
+	ev.phase = phase;
+}
+
+void qdTraceRecorder::write_string(Common::OutSaveFile *fh, const char *str) {
+	if (!str)
+		return;
+
+	Common::String out;
+	for (const char *p = str; *p; p++) {
+		switch (*p) {
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		default:
+			if ((byte)*p < 0x20)
+				out += Common::String::format("\\u%04x", (byte)*p);
+			else
+				out += *p;
+			break;
+		}
+	}
+
+	fh->writeString(out);
+}
+
+} // namespace QDEngine
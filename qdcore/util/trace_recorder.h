@@ -0,0 +1,139 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef QDENGINE_QDCORE_UTIL_TRACE_RECORDER_H
+#define QDENGINE_QDCORE_UTIL_TRACE_RECORDER_H
+
+#include "common/str.h"
+#include "common/std/vector.h"
+
+namespace Common {
+class OutSaveFile;
+}
+
+namespace QDEngine {
+
+//! Запись временной шкалы работы движка в формате Chrome trace events (JSON).
+/**
+События копятся в памяти и записываются в файл в stop().
+Запись заканчивается сама по истечении заданного времени или
+при достижении заданного количества событий - после того, как
+закроются все открытые участки.
+*/
+class qdTraceRecorder {
+public:
+	static qdTraceRecorder &instance();
+
+	static bool is_recording() {
+		return _recording;
+	}
+
+	//! Начало записи в file_name.
+	/**
+	duration - максимальная длительность записи в мс, max_events - максимальное
+	количество событий, 0 - без ограничения.
+	*/
+	bool start(const char *file_name, uint32 duration = 0, uint32 max_events = 0);
+	//! Окончание записи и сохранение файла.
+	bool stop();
+
+	//! Начало участка, detail - необязательная подпись (например имя сцены).
+	/**
+	Возвращает false, если событие не записано, end() для него вызывать не надо.
+	*/
+	bool begin(const char *name, const char *detail = NULL);
+	//! Окончание последнего открытого участка.
+	void end();
+	//! Мгновенное событие.
+	void instant(const char *name, const char *detail = NULL);
+
+	int event_count() const {
+		return _events.size();
+	}
+	const Common::String &file_name() const {
+		return _file_name;
+	}
+
+private:
+	qdTraceRecorder();
+	~qdTraceRecorder();
+
+	struct Event {
+		//! Имя - строковая константа, не копируется.
+		const char *name;
+		Common::String detail;
+		uint32 time;
+		//! Тип события: 'B', 'E' или 'i'.
+		char phase;
+	};
+
+	static bool _recording;
+
+	Common::String _file_name;
+	Std::vector<Event> _events;
+
+	uint32 _start_time;
+	uint32 _duration;
+	uint32 _max_events;
+
+	//! Количество открытых участков.
+	int _depth;
+	//! true, если лимит исчерпан и ждем закрытия открытых участков.
+	bool _closing;
+
+	bool check_limits();
+	void add_event(const char *name, const char *detail, char phase);
+
+	static void write_string(Common::OutSaveFile *fh, const char *str);
+};
+
+//! Участок временной шкалы, от конструктора до деструктора.
+class qdTraceScope {
+public:
+	qdTraceScope(const char *name, const char *detail = NULL) : _active(false) {
+		if (qdTraceRecorder::is_recording())
+			_active = qdTraceRecorder::instance().begin(name, detail);
+	}
+	~qdTraceScope() {
+		if (_active)
+			qdTraceRecorder::instance().end();
+	}
+
+private:
+	bool _active;
+};
+
+} // namespace QDEngine
+
+//! Как и замеры профайлера, при определенном __QD_PROFILE_DISABLE__ не компилируется.
+#ifndef __QD_PROFILE_DISABLE__
+#define QD_TRACE_CONCAT_IMPL(a, b) a##b
+#define QD_TRACE_CONCAT(a, b) QD_TRACE_CONCAT_IMPL(a, b)
+#define QD_TRACE_SCOPE(name) QDEngine::qdTraceScope QD_TRACE_CONCAT(qd_trace_scope_, __LINE__)(name)
+#define QD_TRACE_SCOPE_DETAIL(name, detail) QDEngine::qdTraceScope QD_TRACE_CONCAT(qd_trace_scope_, __LINE__)(name, QDEngine::qdTraceRecorder::is_recording() ? (detail) : NULL)
+#define QD_TRACE_INSTANT(name, detail) do { if (QDEngine::qdTraceRecorder::is_recording()) QDEngine::qdTraceRecorder::instance().instant(name, detail); } while (0)
+#else
+#define QD_TRACE_SCOPE(name)
+#define QD_TRACE_SCOPE_DETAIL(name, detail)
+#define QD_TRACE_INSTANT(name, detail)
+#endif
+
+#endif // QDENGINE_QDCORE_UTIL_TRACE_RECORDER_H
@@ -34,6 +34,7 @@
 #include "qdengine/console.h"
 #include "qdengine/parser/qdscr_parser.h"
 #include "qdengine/qdcore/qd_game_dispatcher.h"
+#include "qdengine/qdcore/util/trace_recorder.h"
 
 namespace QDEngine {
 
@@ -73,6 +74,19 @@ Common::Error QDEngineEngine::run() {
 	// Set the engine's debugger console
 	setDebugger(new Console());
 
+	if (ConfMan.hasKey("async_pathfinding"))
+		_asyncPathfinding = ConfMan.getBool("async_pathfinding");
+
+	if (ConfMan.hasKey("frame_pacing"))
+		_framePacing = ConfMan.getBool("frame_pacing");
+	if (ConfMan.hasKey("frame_rate_cap"))
+		_frameRateCap = MAX(0, ConfMan.getInt("frame_rate_cap"));
+	if (ConfMan.hasKey("fast_forward_quants"))
+		_fastForwardQuants = MAX(-1, ConfMan.getInt("fast_forward_quants"));
+
+	if (ConfMan.hasKey("memory_budget"))
+		_memoryBudget = MAX(0, ConfMan.getInt("memory_budget"));
+
 	// If a savegame was selected from the launcher, load it
 	int saveSlot = ConfMan.getInt("save_slot");
 	if (saveSlot != -1)
@@ -109,6 +123,8 @@ bool canSaveGameStateCurrently(Common::U32String *msg)  {
 }
 
 Common::Error QDEngineEngine::saveGameStream(Common::WriteStream *stream, bool isAutosave) {
+	QD_TRACE_SCOPE(isAutosave ? "autosave" : "save_game");
+
 	if (qdGameDispatcher::get_dispatcher()->save_save(stream))
 		return Common::kNoError;
 
@@ -91,6 +91,10 @@ public:
 		_randomSource.setSeed(seed);
 	}
 
+	uint32 getSeed() const {
+		return _randomSource.getSeed();
+	}
+
 	bool hasFeature(EngineFeature f) const override {
 		return
 		    (f == kSupportsLoadingDuringRuntime) ||
@@ -113,6 +117,18 @@ public:
 	int _thumbSizeX = 0, _thumbSizeY = 0;
 	bool _debugDraw = false;
 	bool _debugDrawGrid = false;
+	// Path requests of followers and group moves are queued and served at the start of the next quant
+	bool _asyncPathfinding = false;
+	// Sleep in the main loop until the next logic quant is due instead of spinning
+	bool _framePacing = true;
+	// Upper limit of redraws per second, 0 - no limit
+	int _frameRateCap = 0;
+	// Logic quants left to run headless at full speed, -1 - until stopped, 0 - off
+	int _fastForwardQuants = 0;
+	// Quants per second measured during the last fast-forward second
+	int _fastForwardRate = 0;
+	// Soft limit of memory taken by loaded resources in KB, a warning is printed when exceeded; 0 - off
+	uint32 _memoryBudget = 0;
 	int _gameVersion = 0;
 
 	// Default text format
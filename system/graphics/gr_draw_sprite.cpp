@@ -25,11 +25,13 @@
 
 #include "qdengine/qdengine.h"
 #include "qdengine/system/graphics/gr_dispatcher.h"
+#include "qdengine/qdcore/util/profiler.h"
 
 namespace QDEngine {
 
 void grDispatcher::putSpr_a(int x, int y, int sx, int sy, const byte *p, int mode, float scale) {
 	debugC(2, kDebugGraphics, "grDispatcher::putSpr_a(%d, %d, %d, %d, scale=%f)", x, y, sx, sy, scale);
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
 
 	int i, j, sx_dest, sy_dest;
 
@@ -89,6 +91,7 @@ void grDispatcher::putSpr_a(int x, int y, int sx, int sy, const byte *p, int mod
 
 void grDispatcher::putSpr(int x, int y, int sx, int sy, const byte *p, int mode, int spriteFormat, float scale) {
 	debugC(2, kDebugGraphics, "grDispatcher::putSpr(%d, %d, %d, %d, scale=%f)", x, y, sx, sy, scale);
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
 
 	int sx_dest = round(float(sx) * scale);
 	int sy_dest = round(float(sy) * scale);
@@ -139,6 +142,7 @@ void grDispatcher::putSpr(int x, int y, int sx, int sy, const byte *p, int mode,
 
 void grDispatcher::putSpr_a(int x, int y, int sx, int sy, const byte *p, int mode) {
 	debugC(2, kDebugGraphics, "grDispatcher::putSpr_a(%d, %d, %d, %d)", x, y, sx, sy);
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
 
 	int px = 0;
 	int py = 0;
@@ -189,6 +193,8 @@ void grDispatcher::putSpr_a(int x, int y, int sx, int sy, const byte *p, int mod
 }
 
 void grDispatcher::putSpr_rot(const Vect2i &pos, const Vect2i &size, const byte *data, bool has_alpha, int mode, float angle) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
+
 	const int F_PREC = 16;
 
 	int xc = pos.x + size.x / 2;
@@ -294,6 +300,8 @@ void grDispatcher::putSpr_rot(const Vect2i &pos, const Vect2i &size, const byte
 }
 
 void grDispatcher::putSpr_rot(const Vect2i &pos, const Vect2i &size, const byte *data, bool has_alpha, int mode, float angle, const Vect2f &scale) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
+
 	const int F_PREC = 16;
 
 	int xc = pos.x + round(float(size.x) * scale.x / 2.f);
@@ -382,6 +390,8 @@ void grDispatcher::putSpr_rot(const Vect2i &pos, const Vect2i &size, const byte
 }
 
 void grDispatcher::putSprMask_rot(const Vect2i &pos, const Vect2i &size, const byte *data, bool has_alpha, uint32 mask_color, int mask_alpha, int mode, float angle) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
+
 	const int F_PREC = 16;
 
 	int xc = pos.x + size.x / 2;
@@ -487,6 +497,8 @@ void grDispatcher::putSprMask_rot(const Vect2i &pos, const Vect2i &size, const b
 }
 
 void grDispatcher::putSprMask_rot(const Vect2i &pos, const Vect2i &size, const byte *data, bool has_alpha, uint32 mask_color, int mask_alpha, int mode, float angle, const Vect2f &scale) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
+
 	const int F_PREC = 16;
 
 	int xc = pos.x + round(float(size.x) * scale.x / 2.f);
@@ -591,6 +603,7 @@ void grDispatcher::putSprMask_rot(const Vect2i &pos, const Vect2i &size, const b
 
 void grDispatcher::putSpr(int x, int y, int sx, int sy, const byte *p, int mode, int spriteFormat) {
 	debugC(2, kDebugGraphics, "grDispatcher::putSpr(%d, %d, %d, %d, %d)", x, y, sx, sy, spriteFormat);
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
 
 	int px = 0;
 	int py = 0;
@@ -995,6 +1008,8 @@ void grDispatcher::putChar(int x, int y, uint32 color, int font_sx, int font_sy,
 }
 
 void grDispatcher::putSprMask(int x, int y, int sx, int sy, const byte *p, uint32 mask_color, int mask_alpha, int mode) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
+
 	int px = 0;
 	int py = 0;
 
@@ -1051,6 +1066,8 @@ void grDispatcher::putSprMask(int x, int y, int sx, int sy, const byte *p, uint3
 }
 
 void grDispatcher::putSprMask(int x, int y, int sx, int sy, const byte *p, uint32 mask_color, int mask_alpha, int mode, float scale) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
+
 	int sx_dest = round(float(sx) * scale);
 	int sy_dest = round(float(sy) * scale);
 
@@ -1111,6 +1128,8 @@ void grDispatcher::putSprMask(int x, int y, int sx, int sy, const byte *p, uint3
 }
 
 void grDispatcher::putSprMask_a(int x, int y, int sx, int sy, const byte *p, uint32 mask_color, int mask_alpha, int mode) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
+
 	int px = 0;
 	int py = 0;
 
@@ -1170,6 +1189,8 @@ void grDispatcher::putSprMask_a(int x, int y, int sx, int sy, const byte *p, uin
 }
 
 void grDispatcher::putSprMask_a(int x, int y, int sx, int sy, const byte *p, uint32 mask_color, int mask_alpha, int mode, float scale) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE);
+
 	int i, j, sx_dest, sy_dest;
 
 	sx_dest = round(float(sx) * scale);
@@ -26,12 +26,14 @@
 #include "qdengine/qd_fwd.h"
 #include "qdengine/system/graphics/gr_dispatcher.h"
 #include "qdengine/system/graphics/rle_compress.h"
+#include "qdengine/qdcore/util/profiler.h"
 
 
 namespace QDEngine {
 
 void grDispatcher::putSpr_rle(int x, int y, int sx, int sy, const class rleBuffer *p, int mode, bool alpha_flag) {
 	debugC(2, kDebugGraphics, "grDispatcher::putSpr_rle(%d, %d, %d, %d)", x, y, sx, sy);
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_RLE);
 
 	int px = 0;
 	int py = 0;
@@ -156,6 +158,7 @@ void grDispatcher::putSpr_rle(int x, int y, int sx, int sy, const class rleBuffe
 
 void grDispatcher::putSpr_rle(int x, int y, int sx, int sy, const class rleBuffer *p, int mode, float scale, bool alpha_flag) {
 	debugC(2, kDebugGraphics, "grDispatcher::putSpr_rle(%d, %d, %d, %d, scale=%f)", x, y, sx, sy, scale);
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_RLE);
 
 	int sx_dest = round(float(sx) * scale);
 	int sy_dest = round(float(sy) * scale);
@@ -236,6 +239,7 @@ void grDispatcher::putSpr_rle(int x, int y, int sx, int sy, const class rleBuffe
 
 void grDispatcher::putSprMask_rle(int x, int y, int sx, int sy, const rleBuffer *p, uint32 mask_color, int mask_alpha, int mode, bool alpha_flag) {
 	debugC(2, kDebugGraphics, "grDispatcher::putSprMask_rle(%d, %d, %d, %d)", x, y, sx, sy);
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_RLE);
 
 	int px = 0;
 	int py = 0;
@@ -390,6 +394,7 @@ void grDispatcher::putSprMask_rle(int x, int y, int sx, int sy, const rleBuffer
 
 void grDispatcher::putSprMask_rle(int x, int y, int sx, int sy, const rleBuffer *p, uint32 mask_color, int mask_alpha, int mode, float scale, bool alpha_flag) {
 	debugC(2, kDebugGraphics, "grDispatcher::putSprMask_rle(%d, %d, %d, %d, scale=%f)", x, y, sx, sy, scale);
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_RLE);
 
 	int sx_dest = round(float(sx) * scale);
 	int sy_dest = round(float(sy) * scale);
@@ -487,6 +492,8 @@ void grDispatcher::putSprMask_rle(int x, int y, int sx, int sy, const rleBuffer
 }
 
 void grDispatcher::putSpr_rle_rot(const Vect2i &pos, const Vect2i &size, const rleBuffer *data, bool has_alpha, int mode, float angle) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_RLE);
+
 	byte *buf = (byte *)temp_buffer(size.x * size.y * 4);
 
 	byte *buf_ptr = buf;
@@ -512,6 +519,8 @@ void grDispatcher::putSpr_rle_rot(const Vect2i &pos, const Vect2i &size, const r
 }
 
 void grDispatcher::putSpr_rle_rot(const Vect2i &pos, const Vect2i &size, const rleBuffer *data, bool has_alpha, int mode, float angle, const Vect2f &scale) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_RLE);
+
 	byte *buf = (byte *)temp_buffer(size.x * size.y * 4);
 
 	byte *buf_ptr = buf;
@@ -537,6 +546,8 @@ void grDispatcher::putSpr_rle_rot(const Vect2i &pos, const Vect2i &size, const r
 }
 
 void grDispatcher::putSprMask_rle_rot(const Vect2i &pos, const Vect2i &size, const rleBuffer *data, bool has_alpha, uint32 mask_color, int mask_alpha, int mode, float angle) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_RLE);
+
 	byte *buf = (byte *)temp_buffer(size.x * size.y * 4);
 
 	byte *buf_ptr = buf;
@@ -562,6 +573,8 @@ void grDispatcher::putSprMask_rle_rot(const Vect2i &pos, const Vect2i &size, con
 }
 
 void grDispatcher::putSprMask_rle_rot(const Vect2i &pos, const Vect2i &size, const rleBuffer *data, bool has_alpha, uint32 mask_color, int mask_alpha, int mode, float angle, const Vect2f &scale) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_RLE);
+
 	byte *buf = (byte *)temp_buffer(size.x * size.y * 4);
 
 	byte *buf_ptr = buf;
@@ -22,6 +22,7 @@
 #include "qdengine/qd_fwd.h"
 #include "qdengine/system/graphics/gr_dispatcher.h"
 #include "qdengine/system/graphics/rle_compress.h"
+#include "qdengine/qdcore/util/profiler.h"
 
 
 namespace QDEngine {
@@ -29,6 +30,7 @@ namespace QDEngine {
 #ifdef _GR_ENABLE_ZBUFFER
 void grDispatcher::putSpr_rle_z(int x, int y, int z, int sx, int sy, const class rleBuffer *p, int mode, bool alpha_flag) {
 	debugC(2, kDebugGraphics, "grDispatcher::putSpr_rle_z(%d, %d, %d, %d, %d)", x, y, z, sx, sy);
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_RLE_Z);
 
 	int px = 0;
 	int py = 0;
@@ -442,6 +444,8 @@ void grDispatcher::putSpr_rle_z(int x, int y, int z, int sx, int sy, const class
 }
 
 void grDispatcher::putSpr_rle_z(int x, int y, int z, int sx, int sy, const class rleBuffer *p, int mode, float scale, bool alpha_flag) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_RLE_Z);
+
 	int sx_dest = round(float(sx) * scale);
 	int sy_dest = round(float(sy) * scale);
 
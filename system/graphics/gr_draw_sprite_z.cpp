@@ -21,12 +21,15 @@
 
 #include "qdengine/qd_fwd.h"
 #include "qdengine/system/graphics/gr_dispatcher.h"
+#include "qdengine/qdcore/util/profiler.h"
 
 
 namespace QDEngine {
 
 #ifdef _GR_ENABLE_ZBUFFER
 void grDispatcher::putSpr_a_z(int x, int y, int z, int sx, int sy, const byte *p, int mode, float scale) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_Z);
+
 	int i, j, sx_dest, sy_dest;
 
 	sx_dest = round(float(sx) * scale);
@@ -133,6 +136,8 @@ void grDispatcher::putSpr_a_z(int x, int y, int z, int sx, int sy, const byte *p
 }
 
 void grDispatcher::putSpr_z(int x, int y, int z, int sx, int sy, const byte *p, int mode, float scale) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_Z);
+
 	int sx_dest = round(float(sx) * scale);
 	int sy_dest = round(float(sy) * scale);
 
@@ -233,6 +238,8 @@ void grDispatcher::putSpr_z(int x, int y, int z, int sx, int sy, const byte *p,
 }
 
 void grDispatcher::putSpr_a_z(int x, int y, int z, int sx, int sy, const byte *p, int mode) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_Z);
+
 	int px = 0;
 	int py = 0;
 
@@ -413,6 +420,8 @@ void grDispatcher::putSpr_a_z(int x, int y, int z, int sx, int sy, const byte *p
 }
 
 void grDispatcher::putSpr_z(int x, int y, int z, int sx, int sy, const byte *p, int mode) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_SPRITE_Z);
+
 	int px = 0;
 	int py = 0;
 
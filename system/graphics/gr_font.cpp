@@ -32,7 +32,7 @@
 
 namespace QDEngine {
 
-grFont::grFont() : _alpha_buffer(NULL) {
+grFont::grFont() : _alpha_buffer(NULL), _alpha_buffer_size(0) {
 	_size_x = _size_y = 0;
 	_alpha_buffer_sx = _alpha_buffer_sy = 0;
 
@@ -112,7 +112,8 @@ bool grFont::load_alpha(Common::SeekableReadStream *fh) {
 
 	int ssx = sx * colors / 8;
 
-	_alpha_buffer = new byte[ssx * sy];
+	_alpha_buffer_size = ssx * sy;
+	_alpha_buffer = new byte[_alpha_buffer_size];
 
 	if (!(flags & 0x20)) {
 		int idx = (sy - 1) * ssx;
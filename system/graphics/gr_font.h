@@ -69,6 +69,11 @@ public:
 		return code == ' ' ? size_x() / 2 : find_char(code).size_x();
 	}
 
+	//! Объем памяти, занятой изображением и индексом символов, в байтах.
+	uint32 data_size() const {
+		return _alpha_buffer_size + _chars.capacity() * sizeof(grFontChar);
+	}
+
 private:
 
 	int _size_x;
@@ -77,6 +82,7 @@ private:
 	int _alpha_buffer_sx;
 	int _alpha_buffer_sy;
 	byte *_alpha_buffer;
+	uint32 _alpha_buffer_size;
 
 	struct grFontChar {
 		grFontChar() : _code(-1) { }
@@ -57,6 +57,11 @@ public:
 		return _tileOffsets.size() - 1;
 	}
 
+	/// объем памяти, занятой индексом кадров и данными тайлов, в байтах
+	uint32 data_size() const {
+		return (_frameIndex.size() + _tileOffsets.size() + _tileData.size()) * sizeof(uint32);
+	}
+
 	void init(int frame_count, const Vect2i &frame_size, bool alpha_flag);
 
 	void compact();
@@ -24,6 +24,7 @@
 #include "qdengine/system/graphics/gr_dispatcher.h"
 #include "qdengine/system/graphics/gr_tile_sprite.h"
 #include "qdengine/qdcore/util/LZ77.h"
+#include "qdengine/qdcore/util/profiler.h"
 
 
 namespace QDEngine {
@@ -97,6 +98,8 @@ bool decodeRLE(const uint32 *in_data, uint32 *out_data) {
 }; // namespace tile_compress
 
 void grDispatcher::putTileSpr(int x, int y, const grTileSprite &sprite, bool has_alpha, int mode) {
+	QD_PROFILE_SCOPE(PROFILE_BLIT_TILE);
+
 	int px = 0;
 	int py = 0;
 
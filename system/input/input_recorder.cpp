@@ -0,0 +1,194 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/debug.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "qdengine/system/input/input_recorder.h"
+
+
+namespace QDEngine {
+
+static const uint32 kInputRecordTag = MKTAG('Q', 'D', 'I', 'R');
+static const uint32 kInputRecordVersion = 1;
+
+inputRecorder::inputRecorder() : _mode(MODE_OFF),
+	_out_file(NULL),
+	_in_file(NULL),
+	_random_seed(0),
+	_logic_period(0),
+	_has_next_record(false),
+	_next_quant(0),
+	_next_type(RECORD_EVENT),
+	_last_record_redraw(false),
+	_last_redraw_quant(0) {
+}
+
+inputRecorder::~inputRecorder() {
+	stop();
+}
+
+inputRecorder *inputRecorder::instance() {
+	static inputRecorder recorder;
+	return &recorder;
+}
+
+bool inputRecorder::start_recording(const char *file_name, uint32 random_seed, int logic_period) {
+	stop();
+
+	_out_file = g_system->getSavefileManager()->openForSaving(file_name, false);
+	if (!_out_file) {
+		warning("inputRecorder::start_recording(): can't create %s", file_name);
+		return false;
+	}
+
+	_random_seed = random_seed;
+	_logic_period = logic_period;
+
+	_out_file->writeUint32BE(kInputRecordTag);
+	_out_file->writeUint32LE(kInputRecordVersion);
+	_out_file->writeUint32LE(_random_seed);
+	_out_file->writeSint32LE(_logic_period);
+
+	_last_record_redraw = false;
+	_mode = MODE_RECORD;
+	return true;
+}
+
+bool inputRecorder::start_replay(const char *file_name) {
+	stop();
+
+	_in_file = g_system->getSavefileManager()->openForLoading(file_name);
+	if (!_in_file) {
+		warning("inputRecorder::start_replay(): can't open %s", file_name);
+		return false;
+	}
+
+	if (_in_file->readUint32BE() != kInputRecordTag || _in_file->readUint32LE() != kInputRecordVersion) {
+		warning("inputRecorder::start_replay(): %s is not an input recording", file_name);
+		stop();
+		return false;
+	}
+
+	_random_seed = _in_file->readUint32LE();
+	_logic_period = _in_file->readSint32LE();
+
+	_mode = MODE_REPLAY;
+	read_record();
+
+	return true;
+}
+
+void inputRecorder::stop() {
+	if (_out_file) {
+		_out_file->finalize();
+		delete _out_file;
+		_out_file = NULL;
+	}
+
+	delete _in_file;
+	_in_file = NULL;
+
+	_has_next_record = false;
+	_mode = MODE_OFF;
+}
+
+void inputRecorder::record_event(const Common::Event &event, uint32 quant_index) {
+	if (!is_recording())
+		return;
+
+	switch (event.type) {
+	case Common::EVENT_KEYDOWN:
+	case Common::EVENT_KEYUP:
+	case Common::EVENT_MOUSEMOVE:
+	case Common::EVENT_LBUTTONDOWN:
+	case Common::EVENT_RBUTTONDOWN:
+	case Common::EVENT_LBUTTONUP:
+	case Common::EVENT_RBUTTONUP:
+		break;
+	default:
+		return;
+	}
+
+	_out_file->writeUint32LE(quant_index);
+	_out_file->writeByte(RECORD_EVENT);
+	_out_file->writeUint32LE(event.type);
+	_out_file->writeSint16LE(event.mouse.x);
+	_out_file->writeSint16LE(event.mouse.y);
+	_out_file->writeSint32LE(event.kbd.keycode);
+	_out_file->writeUint16LE(event.kbd.ascii);
+	_out_file->writeByte(event.kbd.flags);
+
+	_last_record_redraw = false;
+}
+
+void inputRecorder::record_redraw(uint32 quant_index) {
+	if (!is_recording())
+		return;
+
+	// Повторные отрисовки без логики и ввода между ними ничего не меняют.
+	if (_last_record_redraw && _last_redraw_quant == quant_index)
+		return;
+
+	_out_file->writeUint32LE(quant_index);
+	_out_file->writeByte(RECORD_REDRAW);
+
+	_last_record_redraw = true;
+	_last_redraw_quant = quant_index;
+}
+
+bool inputRecorder::next_record(uint32 quant_index, recordType &type, Common::Event &event) {
+	if (!is_replaying() || !_has_next_record || _next_quant > quant_index)
+		return false;
+
+	type = _next_type;
+	if (type == RECORD_EVENT)
+		event = _next_event;
+
+	read_record();
+
+	return true;
+}
+
+bool inputRecorder::read_record() {
+	_next_quant = _in_file->readUint32LE();
+	_next_type = recordType(_in_file->readByte());
+
+	if (_next_type == RECORD_EVENT) {
+		Common::Event event;
+		event.type = Common::EventType(_in_file->readUint32LE());
+		event.mouse.x = _in_file->readSint16LE();
+		event.mouse.y = _in_file->readSint16LE();
+		event.kbd.keycode = Common::KeyCode(_in_file->readSint32LE());
+		event.kbd.ascii = _in_file->readUint16LE();
+		event.kbd.flags = _in_file->readByte();
+
+		_next_event = event;
+	}
+
+	_has_next_record = !_in_file->eos() && !_in_file->err() && (_next_type == RECORD_EVENT || _next_type == RECORD_REDRAW);
+
+	return _has_next_record;
+}
+
+} // namespace QDEngine
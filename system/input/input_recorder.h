@@ -0,0 +1,137 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef QDENGINE_SYSTEM_INPUT_INPUT_RECORDER_H
+#define QDENGINE_SYSTEM_INPUT_INPUT_RECORDER_H
+
+#include "common/events.h"
+
+namespace Common {
+class InSaveFile;
+class OutSaveFile;
+}
+
+namespace QDEngine {
+
+//! Запись и воспроизведение ввода.
+/**
+Запоминает события мыши и клавиатуры вместе с номером логического кванта,
+перед которым они пришли, а также начальное значение генератора случайных
+чисел и период логики. При воспроизведении события подаются в
+input::mouse_wndproc() и input::keyboard_wndproc() перед теми же квантами.
+
+Отрисовки кадров тоже записываются: список видимых объектов, по которому
+ищутся объекты под мышью, обновляется при отрисовке, поэтому при
+воспроизведении кадры рисуются там же, где и при записи.
+*/
+class inputRecorder {
+public:
+	inputRecorder();
+	~inputRecorder();
+
+	//! Тип записи.
+	enum recordType {
+		//! событие мыши или клавиатуры
+		RECORD_EVENT,
+		//! отрисовка кадра
+		RECORD_REDRAW
+	};
+
+	enum recorderMode {
+		MODE_OFF,
+		//! запись ввода
+		MODE_RECORD,
+		//! воспроизведение записи
+		MODE_REPLAY
+	};
+
+	recorderMode mode() const {
+		return _mode;
+	}
+	bool is_recording() const {
+		return _mode == MODE_RECORD;
+	}
+	bool is_replaying() const {
+		return _mode == MODE_REPLAY;
+	}
+
+	//! Начинает запись ввода в сэйв-файл file_name.
+	bool start_recording(const char *file_name, uint32 random_seed, int logic_period);
+	//! Открывает сэйв-файл file_name для воспроизведения.
+	bool start_replay(const char *file_name);
+	//! Заканчивает запись или воспроизведение.
+	void stop();
+
+	//! Начальное значение генератора случайных чисел из записи.
+	uint32 random_seed() const {
+		return _random_seed;
+	}
+	//! Период логики, с которым была сделана запись.
+	int logic_period() const {
+		return _logic_period;
+	}
+
+	//! Записывает событие, пришедшее перед квантом quant_index.
+	/**
+	События, которые не обрабатываются диспетчерами мыши и клавиатуры, пропускаются.
+	*/
+	void record_event(const Common::Event &event, uint32 quant_index);
+	//! Записывает отрисовку кадра, сделанную после кванта quant_index.
+	void record_redraw(uint32 quant_index);
+	//! Возвращает очередную запись для кванта quant_index.
+	/**
+	Для RECORD_EVENT событие возвращается в event.
+	Возвращает false, если записей для этого кванта больше нет.
+	*/
+	bool next_record(uint32 quant_index, recordType &type, Common::Event &event);
+	//! Возвращает true, если все записи воспроизведены.
+	bool is_replay_finished() const {
+		return !_has_next_record;
+	}
+
+	//! Возвращает указатель на текущий объект.
+	static inputRecorder *instance();
+
+private:
+	recorderMode _mode;
+
+	Common::OutSaveFile *_out_file;
+	Common::InSaveFile *_in_file;
+
+	uint32 _random_seed;
+	int _logic_period;
+
+	//! Очередная прочитанная запись.
+	bool _has_next_record;
+	uint32 _next_quant;
+	recordType _next_type;
+	Common::Event _next_event;
+
+	//! Последняя сделанная запись - отрисовка кадра после кванта _last_redraw_quant.
+	bool _last_record_redraw;
+	uint32 _last_redraw_quant;
+
+	bool read_record();
+};
+
+} // namespace QDEngine
+
+#endif // QDENGINE_SYSTEM_INPUT_INPUT_RECORDER_H
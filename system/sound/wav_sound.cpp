@@ -33,6 +33,7 @@ namespace QDEngine {
 
 wavSound::wavSound() : _data(NULL) {
 	_data_length = 0;
+	_stream_size = 0;
 	_bits_per_sample = 0;
 	_channels = 0;
 	_samples_per_sec = 0;
@@ -79,8 +80,11 @@ bool wavSound::wav_file_load(const char *fname) {
 	Common::Path fpath(fname, '\\');
 	Common::SeekableReadStream *stream;
 
-	if (qdFileManager::instance().open_file(&stream, fpath.toString().c_str(), false))
+	if (qdFileManager::instance().open_file(&stream, fpath.toString().c_str(), false)) {
 		_audioStream = Audio::makeWAVStream(stream, DisposeAfterUse::NO);
+		// Звуки из пакетов целиком лежат в памяти
+		_stream_size = qdFileManager::instance().is_packed_file(fpath.toString().c_str()) ? stream->size() : 0;
+	}
 
 	warning("STUB: wav_file_load() %s", transCyrillic(fname));
 	return true;
@@ -38,6 +38,13 @@ public:
 	int data_length() const {
 		return _data_length;
 	}
+	//! Объем памяти, занятой звуком: данные и поток в памяти.
+	/**
+	Поток, который читается с диска, в памяти не хранится и не учитывается.
+	*/
+	uint32 data_size() const {
+		return (_data ? _data_length : 0) + (_audioStream ? _stream_size : 0);
+	}
 	int bits_per_sample() const {
 		return _bits_per_sample;
 	}
@@ -77,6 +84,8 @@ private:
 	char *_data;
 	//! Длина данных.
 	int _data_length;
+	//! Размер потока в памяти, из которого читается звук, 0 - поток читается с диска.
+	uint32 _stream_size;
 	//! Количество бит на сэмпл (8/16).
 	int _bits_per_sample;
 	//! Количество каналов (1/2 - моно/стерео).